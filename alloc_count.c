@@ -0,0 +1,29 @@
+#include <stdlib.h>
+#include "alloc_count.h"
+
+/**
+ * Allocation counter for the count build (make count). The linker redirects
+ * malloc, calloc and realloc here with --wrap, and every call is counted
+ * before being passed on to the real allocator.
+*/
+
+long alloc_calls = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void *ptr, size_t size);
+
+void* __wrap_malloc(size_t size){
+    alloc_calls++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size){
+    alloc_calls++;
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void *ptr, size_t size){
+    alloc_calls++;
+    return __real_realloc(ptr, size);
+}
@@ -0,0 +1,7 @@
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+// number of malloc, calloc and realloc calls made so far, only in the count build
+extern long alloc_calls;
+
+#endif
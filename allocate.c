@@ -2,462 +2,666 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
-#include "process_q.h"
-#include "memory.h" 
-#include "frame.h"
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "engine.h"
+#ifdef COUNT_ALLOC
+#include <time.h>
+#include <sys/resource.h>
+#include "alloc_count.h"
+#endif
+
+#define READ_CHUNK (1 << 16) // initial buffer size for traces that cannot be mapped
+#define PROCESS_CHUNK 1024 // initial number of records in the process slab
+#define METHOD_NUMBER 8 // number of memory allocation methods
+#define MAX_QUANTUM 3 // longest quantum length
+#define MAX_CPUS 64 // most CPUs a run may have
+
+static char *methods[METHOD_NUMBER] = {"infinite", "first-fit", "best-fit", "next-fit", "worst-fit", "buddy", "paged", "virtual"};
+
+typedef struct Options{
+    char *filename; // trace file
+    char *method; // memory allocation method
+    int quantum; // quantum length
+    int policy; // page replacement policy for virtual, -1 if not given
+    int memory_size; // size of contiguous and buddy memory
+    int frame_number; // number of frames for paged and virtual
+    int page_size; // page and frame size for paged and virtual
+    int summary; // 1 to print only the performance statistics
+    char *trace; // binary event trace written instead of the event log, NULL if none
+    int sweep; // 1 to compare every method and quantum not fixed by -m and -q
+    int scheduler; // RR, SRTF or MLFQ
+    int cpus; // number of CPUs running processes at the same time
+    char *checkpoint; // snapshot written when the run reaches checkpoint_at, NULL if none
+    long long checkpoint_at; // time stamp to save the run at
+    char *resume; // snapshot the run resumes from, NULL to start at time 0
+    int stream; // 1 to read processes from stdin as they arrive, given as -f -
+    int compact; // 1 to compact contiguous memory when no hole fits a process but the free memory does
+    int stats; // 1 to print counters and phase times as JSON after the performance statistics
+    char *access; // access model of demand paging for virtual, NULL if pages are not modelled
+    long long fault_latency; // time a page fault stalls a process for under demand paging
+    Access_model *access_model; // the model read from access
+} Options;
+
+typedef struct Sweep_run{
+    char *method; // memory allocation method of this run
+    int quantum; // quantum length of this run
+    Options *opts; // options shared by every run
+    Process **shared; // parsed processes, only read by the runs
+    int p_cnt; // number of processes
+    Performance perf; // results of this run
+} Sweep_run;
+
+void read_command(int argc, char *argv[], Options *opts);
+
+Process** read_process(int argc, char *argv[], Options *opts, int *p_cnt);
+
+long long run_method(Process **proc_list, int p_cnt, char *method, int quantum, Options *opts, Checkpoint *ck, Process_stream *stream, Page_stats *stats, Compact_stats *compaction);
+
+void prepare_checkpoint(Checkpoint *ck, Options *opts, Process **proc_list, int p_cnt);
+
+void sweep(Process **proc_list, int p_cnt, Options *opts);
 
-void print_performance(Process **proc_list, int cnt, int time_complete);
-
-char* read_command(int argc, char *argv[], char **method, int *quantum);
-
-Process** read_process(int argc, char *argv[], char **method, int *quantum, int *p_cnt);
-
-int infinite(Process **proc_list, int p_cnt, int quantum);
-
-int first_fit(Process **proc_list, int p_cnt, int quantum);
-
-int paged(Process **proc_list, int p_cnt, int quantum);
-
-int virtual(Process **proc_list, int p_cnt, int quantum);
 
 
 int main(int argc, char *argv[]) {
-    char *method = NULL;
-    int quantum = 0;
+    Options opts;
     int p_cnt = 0;
     Process **proc_list;  // List of processes
 
+#ifdef COUNT_ALLOC
+    struct timespec parse_start, parse_end;
+    clock_gettime(CLOCK_MONOTONIC, &parse_start);
+#endif
     // read processes to process list
-    proc_list = read_process(argc, argv, &method, &quantum, &p_cnt);
-
-    int time_stamp;
-    if (strcmp(method, "infinite") == 0) { 
-        time_stamp = infinite(proc_list, p_cnt, quantum);
-    }else if (strcmp(method, "first-fit") == 0){
-        time_stamp = first_fit(proc_list, p_cnt, quantum);
-    }else if (strcmp(method, "paged") == 0){
-        time_stamp = paged(proc_list, p_cnt, quantum);
-    } else {
-        time_stamp = virtual(proc_list, p_cnt, quantum);
+    proc_list = read_process(argc, argv, &opts, &p_cnt);
+    STAT_PHASE(PHASE_SCHEDULE);
+#ifdef COUNT_ALLOC
+    long parse_allocs = alloc_calls;
+    clock_gettime(CLOCK_MONOTONIC, &parse_end);
+    struct stat trace_st;
+    double parse_mb = stat(opts.filename, &trace_st) == 0 ? trace_st.st_size / 1e6 : 0;
+    double parse_secs = (parse_end.tv_sec - parse_start.tv_sec) + (parse_end.tv_nsec - parse_start.tv_nsec) / 1e9;
+    fprintf(stderr, "parse: %d processes, %.1f MB in %.3fs, %.1f MB/s\n", p_cnt, parse_mb, parse_secs, parse_mb / parse_secs);
+#endif
+
+    if (opts.sweep) {
+        sweep(proc_list, p_cnt, &opts);
+        free_process(proc_list, p_cnt);
+        return EXIT_SUCCESS;
     }
 
-    print_performance(proc_list, p_cnt, time_stamp);
-
+    long long time_stamp;
+    Page_stats stats;
+    Compact_stats compaction = {0, 0};
+    Checkpoint ck;
+    prepare_checkpoint(&ck, &opts, proc_list, p_cnt);
+    Process_stream *stream = opts.stream ? open_stream(STDIN_FILENO, "stdin", opts.quantum) : NULL;
+    out_init(opts.summary ? OUT_QUIET : OUT_TEXT, opts.cpus);
+    if (opts.trace && out_open_trace(opts.trace, proc_list, p_cnt, opts.cpus) == -1) {
+        fprintf(stderr, "Cannot open %s\n", opts.trace);
+        exit(EXIT_FAILURE);
+    }
+#ifdef COUNT_ALLOC
+    struct timespec sim_start, sim_end;
+    clock_gettime(CLOCK_MONOTONIC, &sim_start);
+#endif
+    time_stamp = run_method(proc_list, p_cnt, opts.method, opts.quantum, &opts, &ck, stream, &stats, &compaction);
+
+#ifdef COUNT_ALLOC
+    clock_gettime(CLOCK_MONOTONIC, &sim_end);
+    double sim_secs = (sim_end.tv_sec - sim_start.tv_sec) + (sim_end.tv_nsec - sim_start.tv_nsec) / 1e9;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(stderr, "allocations: parse %ld, simulation %ld\n", parse_allocs, alloc_calls - parse_allocs);
+    fprintf(stderr, "simulation: %lld events in %.3fs, %.0f events/s\n", out_events(), sim_secs, out_events() / sim_secs);
+    fprintf(stderr, "peak RSS: %ld KB\n", usage.ru_maxrss);
+    if (stream) fprintf(stderr, "stream: %d processes, at most %d records live\n", stream->read, stream->peak);
+#endif
+    if (ck.saved) {
+        // the run stopped at the checkpoint, the resumed run reports performance
+        out_close();
+        fprintf(stderr, "Saved the run at time %lld to %s\n", time_stamp, opts.checkpoint);
+        if (ck.resume) free_snapshot(ck.resume);
+        free_process(proc_list, p_cnt);
+        return EXIT_SUCCESS;
+    }
+    if (opts.checkpoint) fprintf(stderr, "Finished at time %lld, before the checkpoint\n", time_stamp);
+    STAT_PHASE(PHASE_OUTPUT);
+    if (opts.policy != -1) log_page_stats(stats.evictions, stats.refaults);
+    if (opts.compact) log_compact_stats(compaction.compactions, compaction.moved);
+    out_close();
+    if (stream) print_totals(&stream->totals, time_stamp);
+    else print_performance(proc_list, p_cnt, time_stamp);
+    if (opts.policy != -1) {
+        // page replacement report, only when a policy is chosen explicitly
+        printf("Evictions %d\n", stats.evictions);
+        printf("Refaults %d\n", stats.refaults);
+    }
+    if (opts.compact) {
+        // compaction report, only when compaction is asked for
+        printf("Compactions %d\n", compaction.compactions);
+        printf("Moved %lld\n", compaction.moved);
+    }
+    if (opts.access_model) print_page_faults(proc_list, p_cnt, opts.fault_latency);
+    if (opts.stats) print_stats();
+
+    if (ck.resume) free_snapshot(ck.resume);
+    if (stream) free_stream(stream);
+    if (opts.access_model) {
+        for (int i = 0; i < p_cnt; i++) free_page_table(proc_list[i]->pt);
+        free_access_model(opts.access_model);
+    }
     free_process(proc_list, p_cnt);
 
     return EXIT_SUCCESS;
 }
 
 /**
- * Function to calculate and print turnaround time, time overhead and makespan.
+ * Function to simulate the processes with a memory allocation method
+ *
+ * Input:
+ * process list;
+ * p_cnt: number of processes;
+ * method and quantum of the run;
+ * opts: scheduler, CPUs, memory size, frame number, page size, page
+ * replacement policy and access model;
+ * ck: checkpoint to save the run at or resume it from, NULL if none;
+ * stream: where processes are read as they arrive, NULL to simulate the process list;
+ * stats: eviction and refault counts of virtual;
+ * compaction: compaction counts of contiguous methods.
  *
- * Input: process list which contains all processes;
- * cnt to count the number of processses;
- * time_complete is the time stamp when all processses are finished.
+ * Return: the time stamp when all processes are finished
 */
-void print_performance(Process **proc_list, int cnt, int time_complete){
-    int total= 0;
-    double total_over = 0;
-    double max_over = 0;
-    for(int i = 0; i < cnt; i++){
-        total += proc_list[i]->complete_time - proc_list[i]->arr_time;
-        double over = ((double)(proc_list[i]->complete_time - proc_list[i]->arr_time))/(double)proc_list[i]->serv_time;
-        total_over += over;
-        if(over > max_over) max_over = over;
+long long run_method(Process **proc_list, int p_cnt, char *method, int quantum, Options *opts, Checkpoint *ck, Process_stream *stream, Page_stats *stats, Compact_stats *compaction){
+    if (strcmp(method, "infinite") == 0) { 
+        return infinite(proc_list, p_cnt, quantum, opts->scheduler, opts->cpus, ck, stream);
+    }else if (strcmp(method, "first-fit") == 0){
+        return contiguous(proc_list, p_cnt, quantum, opts->scheduler, opts->cpus, ck, stream, FIRST_FIT, opts->memory_size, opts->compact, compaction);
+    }else if (strcmp(method, "best-fit") == 0){
+        return contiguous(proc_list, p_cnt, quantum, opts->scheduler, opts->cpus, ck, stream, BEST_FIT, opts->memory_size, opts->compact, compaction);
+    }else if (strcmp(method, "next-fit") == 0){
+        return contiguous(proc_list, p_cnt, quantum, opts->scheduler, opts->cpus, ck, stream, NEXT_FIT, opts->memory_size, opts->compact, compaction);
+    }else if (strcmp(method, "worst-fit") == 0){
+        return contiguous(proc_list, p_cnt, quantum, opts->scheduler, opts->cpus, ck, stream, WORST_FIT, opts->memory_size, opts->compact, compaction);
+    }else if (strcmp(method, "buddy") == 0){
+        return buddy(proc_list, p_cnt, quantum, opts->scheduler, opts->cpus, ck, stream, opts->memory_size);
+    }else if (strcmp(method, "paged") == 0){
+        return paged(proc_list, p_cnt, quantum, opts->scheduler, opts->cpus, ck, stream, opts->frame_number, opts->page_size);
     }
-    printf("Turnaround time %.f\n", ceil((double)total/(double)cnt));
-    printf("Time overhead %.2f %.2f\n", max_over, ((int)(total_over/cnt * 100 + 0.5)) / 100.0);
-    printf("Makespan %d\n", time_complete);
+    return virtual(proc_list, p_cnt, quantum, opts->scheduler, opts->cpus, ck, stream, opts->frame_number, opts->page_size, opts->policy == -1 ? LRU : opts->policy, opts->access_model, stats);
 }
 
 /**
- * Function to read command line, load method and quantum according to command line
- * 
- * Return: file name
+ * Function to check if a method allocates contiguous memory with a fit strategy
 */
-char* read_command(int argc, char *argv[], char **method, int *quantum) {
+static int is_contiguous(char *method){
+    return strcmp(method, "first-fit") == 0 || strcmp(method, "best-fit") == 0 ||
+        strcmp(method, "next-fit") == 0 || strcmp(method, "worst-fit") == 0;
+}
 
-    char *filename = NULL;
-    if (argc != 7) {  // Expecting 6 arguments plus the program name
-        exit(EXIT_FAILURE);
+/**
+ * Function to run one configuration of a sweep on a worker thread. The engines
+ * update the records they simulate, so the run works on its own copy of the
+ * shared processes and logs to its own writer.
+*/
+static void* sweep_run(void *arg){
+    Sweep_run *run = (Sweep_run*)arg;
+    int p_cnt = run->p_cnt;
+    Process *slab = p_cnt > 0 ? (Process*)malloc(sizeof(Process) * p_cnt) : NULL;
+    Process **proc_list = (Process**)malloc(sizeof(Process*) * (p_cnt > 0 ? p_cnt : 1));
+    for (int i = 0; i < p_cnt; i++) {
+        slab[i] = *run->shared[i];
+        proc_list[i] = &slab[i];
     }
 
-    for (int i = 1; i < argc; i += 2) {
-        if (strcmp(argv[i], "-f") == 0) {
-            filename = argv[i + 1];
-        } else if (strcmp(argv[i], "-m") == 0) {
-            *method = argv[i + 1];
-            if (strcmp(*method, "infinite") != 0 && strcmp(*method, "first-fit") != 0 &&
-                strcmp(*method, "paged") != 0 && strcmp(*method, "virtual") != 0) {
-                fprintf(stderr, "Invalid memory allocation method: %s\n", *method);
-                exit(EXIT_FAILURE);
-            }
-        } else if (strcmp(argv[i], "-q") == 0) {
-            *quantum = atoi(argv[i + 1]);
-            if (*quantum < 1 || *quantum > 3) {
-                fprintf(stderr, "Invalid quality value: %d. Must be 1, 2, or 3.\n", *quantum);
-                exit(EXIT_FAILURE);
-            }
+    out_init(OUT_QUIET, run->opts->cpus);
+    if (run->opts->trace) {
+        // each run records to <trace>.<method>.q<quantum>
+        char *path = (char*)malloc(strlen(run->opts->trace) + strlen(run->method) + 8);
+        sprintf(path, "%s.%s.q%d", run->opts->trace, run->method, run->quantum);
+        if (out_open_trace(path, proc_list, p_cnt, run->opts->cpus) == -1) {
+            fprintf(stderr, "Cannot open %s\n", path);
+            exit(EXIT_FAILURE);
         }
+        free(path);
     }
-
-    if (!filename || !*method) {
-        fprintf(stderr, "Missing required arguments.\n");
-        exit(EXIT_FAILURE);
-    }
-    return filename;
+    Page_stats stats;
+    Compact_stats compaction;
+    long long time_stamp = run_method(proc_list, p_cnt, run->method, run->quantum, run->opts, NULL, NULL, &stats, &compaction);
+    if (run->opts->policy != -1 && strcmp(run->method, "virtual") == 0) log_page_stats(stats.evictions, stats.refaults);
+    if (run->opts->compact && is_contiguous(run->method)) log_compact_stats(compaction.compactions, compaction.moved);
+    out_close();
+
+    measure_performance(proc_list, p_cnt, time_stamp, &run->perf);
+    free_process(proc_list, p_cnt);
+    return NULL;
 }
 
 /**
- * Function to read processes, change p_cnt as process counter. 
- * 
- * Return: a process list.
+ * Function to run every method and quantum not fixed on the command line,
+ * each on its own thread, and print their performance side by side
+ *
+ * Input:
+ * process list, read by every run but never changed;
+ * p_cnt: number of processes;
+ * opts: the options the runs share.
 */
-Process** read_process(int argc, char *argv[], char **method, int *quantum, int *p_cnt) {
-
-    // read file name, method and quantum from command line
-    char *filename = read_command(argc, argv, method, quantum);
-
-    // open file
-    FILE *f = fopen(filename, "r");
-
-    char att[MAX_DIGIT];
-    int att_cnt = 0, i = 0;
-    int t_arr, t_serv, mem;
-    char pname[MAX_NAME_LENGTH]; 
-
-    Process **proc_list = NULL; // Initialize a process list
-    *p_cnt = 0; // Initialize the process count
-
-    // read file
-    char c;
-    while ((c = fgetc(f)) != EOF) {
-        if (c == ' ' || c == '\n') {
-            // when an attribute is read
-            att[i] = '\0';
-            switch (att_cnt) {
-                case 0: 
-                //the first attribute is the arrival time of this process
-                t_arr = atoi(att); 
-                break;
-
-                case 1: 
-                //the second attribute is the name of this process
-                strcpy(pname, att); 
-                break;
-
-                case 2: 
-                //the third attribute is the service time of this process
-                t_serv = atoi(att); 
-                break;
-
-                case 3: 
-                //the fourth attribute is the memory usage of this process
-                mem = atoi(att); 
-                break;
-            }
-            i = 0;
-            att_cnt++;
-            if (c == '\n') {
-                // if a process has been read
-                Process **temp = realloc(proc_list, sizeof(Process*) * (*p_cnt + 1));
-                proc_list = temp;
-                att_cnt = 0; 
-                proc_list[*p_cnt] = initialize_p(pname, t_arr, t_serv, mem);
-                (*p_cnt)++;
+void sweep(Process **proc_list, int p_cnt, Options *opts){
+    Sweep_run *runs = (Sweep_run*)malloc(sizeof(Sweep_run) * METHOD_NUMBER * MAX_QUANTUM);
+    pthread_t *threads = (pthread_t*)malloc(sizeof(pthread_t) * METHOD_NUMBER * MAX_QUANTUM);
+    int run_cnt = 0;
+    for (int m = 0; m < METHOD_NUMBER; m++) {
+        if (opts->method && strcmp(opts->method, methods[m]) != 0) continue;
+        for (int q = 1; q <= MAX_QUANTUM; q++) {
+            if (opts->quantum && opts->quantum != q) continue;
+            Sweep_run *run = &runs[run_cnt];
+            run->method = methods[m];
+            run->quantum = q;
+            run->opts = opts;
+            run->shared = proc_list;
+            run->p_cnt = p_cnt;
+            if (pthread_create(&threads[run_cnt], NULL, sweep_run, run) != 0) {
+                fprintf(stderr, "Cannot start a thread for %s with quantum %d\n", run->method, q);
+                exit(EXIT_FAILURE);
             }
-        } else {
-            att[i++] = c;
+            run_cnt++;
         }
     }
-    // close file
-    fclose(f);
-    return proc_list;
+    for (int i = 0; i < run_cnt; i++) pthread_join(threads[i], NULL);
+
+    printf("%-10s %2s %11s %13s %13s %10s\n", "method", "q", "turnaround", "max-overhead", "avg-overhead", "makespan");
+    for (int i = 0; i < run_cnt; i++) {
+        Performance *perf = &runs[i].perf;
+        printf("%-10s %2d %11.f %13.2f %13.2f %10lld\n", runs[i].method, runs[i].quantum,
+            perf->turnaround, perf->max_over, perf->avg_over, perf->makespan);
+    }
+
+    free(threads);
+    free(runs);
 }
 
 /**
- * Function to run infinite algorithm, corresponding to task 1.
- * 
- * Return: the time stamp when all processes are finished.
+ * Function to set up the checkpoint of a run. Resuming maps the snapshot,
+ * checks that the trace starts with its processes and takes the method and
+ * options of the run from it.
+ *
+ * Input:
+ * ck: the checkpoint to set up;
+ * opts: the options, changed to those of the snapshot when resuming;
+ * process list and p_cnt.
 */
-int infinite(Process **proc_list, int p_cnt, int quantum) {
-
-    // initialize a ready queue for processes in ready state
-    Queue *ready_q = initialize_q();
-
-    int time_stamp = 0;
-    int rem_p = p_cnt;
-    Process *running = NULL;
-
-    while(rem_p != 0){
-        // if proesses haven't finished
-        for(int i = 0; i < p_cnt; i++){
-            if(proc_list[i]->arr_time <= time_stamp && proc_list[i]->arr_time > time_stamp - quantum){
-                // for processes are arrived at this quantum, add them to queue
-                enqueue(ready_q, proc_list[i]);
-            }
+void prepare_checkpoint(Checkpoint *ck, Options *opts, Process **proc_list, int p_cnt){
+    ck->at = opts->checkpoint ? opts->checkpoint_at : -1;
+    ck->path = opts->checkpoint;
+    ck->saved = 0;
+    ck->resume = NULL;
+    if (opts->resume) {
+        Snapshot *s = open_snapshot(opts->resume);
+        if (s == NULL) {
+            fprintf(stderr, "%s is not a snapshot\n", opts->resume);
+            exit(EXIT_FAILURE);
         }
-        if(running && running->rem_time == 0){
-            // for processses are finished at the start of this quantum
-            printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", time_stamp, running->pname, q_size(ready_q));
-            running->complete_time = time_stamp;
-            running = NULL;
+        Snapshot_header *h = s->header;
+        if (!snapshot_matches(s, proc_list, p_cnt)) {
+            fprintf(stderr, "%s does not start with the processes of %s\n", opts->filename, opts->resume);
+            exit(EXIT_FAILURE);
         }
-        if(!isEmpty(ready_q)){
-            // run a process from ready queue
-            if(running) enqueue(ready_q, running);
-            running = dequeue(ready_q);
-            printf("%d,RUNNING,process-name=%s,remaining-time=%d\n", time_stamp, running->pname, running->rem_time);
+        if ((opts->method && strcmp(opts->method, h->method) != 0) || (opts->quantum && opts->quantum != h->quantum)) {
+            fprintf(stderr, "%s was saved with -m %s -q %d\n", opts->resume, h->method, h->quantum);
+            exit(EXIT_FAILURE);
         }
-
-        time_stamp += quantum;
-        if (running) {
-            // update remaining time if there is a process running at this time stamp
-            running->rem_time = running->rem_time - quantum; }
-
-        if(running && running->rem_time < 0) {
-            // if there is a process finished at this time stamp
-            running->rem_time = 0;}
-        rem_p = remaining_p(proc_list, p_cnt); // check how many processes are not finished
-        if(rem_p == 0){
-            // if the last process is finished at this timestamp
-            printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", time_stamp, running->pname, q_size(ready_q));
-            running->complete_time = time_stamp;
+        int m = 0;
+        while (m < METHOD_NUMBER && strcmp(h->method, methods[m]) != 0) m++;
+        if (m == METHOD_NUMBER || h->quantum < 1 || h->quantum > MAX_QUANTUM || h->cpus > MAX_CPUS) {
+            fprintf(stderr, "%s is not a snapshot\n", opts->resume);
+            exit(EXIT_FAILURE);
         }
+        opts->method = methods[m];
+        opts->quantum = h->quantum;
+        opts->scheduler = h->scheduler;
+        opts->cpus = h->cpus;
+        opts->policy = h->policy;
+        opts->memory_size = h->memory_size;
+        opts->frame_number = h->frame_number;
+        opts->page_size = h->page_size;
+        opts->compact = h->compact;
+        ck->resume = s;
     }
-    // free ready_queue
-    free_q(ready_q);
-    return time_stamp;
+
+    // what a snapshot of this run records
+    memset(&ck->settings, 0, sizeof(ck->settings));
+    strncpy(ck->settings.method, opts->method, METHOD_LENGTH - 1);
+    ck->settings.quantum = opts->quantum;
+    ck->settings.scheduler = opts->scheduler;
+    ck->settings.cpus = opts->cpus;
+    ck->settings.policy = opts->policy;
+    ck->settings.memory_size = opts->memory_size;
+    ck->settings.frame_number = opts->frame_number;
+    ck->settings.page_size = opts->page_size;
+    ck->settings.compact = opts->compact;
 }
 
 /**
- * Function to run first fit algorithm, corresponding to task 2
- * 
- * Return time stamp when all processes are finished
+ * Function to read a positive size given for a command line option
+ *
+ * Return: the size, exits if it is not a positive integer
 */
-int first_fit(Process **proc_list, int p_cnt, int quantum){
-
-
-    Memory *memory = initialize_memory(MEMORY_SIZE);
-
-    // initialize a ready queue for processes in ready state
-    Queue *ready_q = initialize_q(); 
-    int time_stamp = 0;
-    int rem_p = p_cnt;
-    Process *running = NULL;
+static int read_size(char *option, char *value){
+    char *end;
+    long size = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || size < 1 || size > INT_MAX / 2) {
+        fprintf(stderr, "Invalid value for %s: %s\n", option, value);
+        exit(EXIT_FAILURE);
+    }
+    return (int)size;
+}
 
-    while(rem_p != 0){
-        // if proesses haven't finished
-        for(int i = 0; i < p_cnt; i++){
-            if(proc_list[i]->arr_time <= time_stamp && proc_list[i]->arr_time > time_stamp - quantum){
-                // for processes are arrived at this quantum, add them to queue
-                enqueue(ready_q, proc_list[i]);
-            }
+/**
+ * Function to read command line, load file name, method, quantum, scheduler,
+ * number of CPUs, page replacement policy, memory size, frame number, page
+ * size, summary mode, binary trace, sweep mode, compaction, counters, demand
+ * paging and checkpoints according to command line.
+ * A file name of - reads processes from stdin as the run reaches them.
+*/
+void read_command(int argc, char *argv[], Options *opts) {
+
+    opts->filename = NULL;
+    opts->method = NULL;
+    opts->quantum = 0;
+    opts->policy = -1;
+    opts->memory_size = MEMORY_SIZE;
+    opts->frame_number = -1;
+    opts->page_size = PAGE_SIZE;
+    opts->summary = 0;
+    opts->trace = NULL;
+    opts->sweep = 0;
+    opts->scheduler = RR;
+    opts->cpus = 1;
+    opts->checkpoint = NULL;
+    opts->checkpoint_at = -1;
+    opts->resume = NULL;
+    opts->stream = 0;
+    opts->compact = 0;
+    opts->stats = 0;
+    opts->access = NULL;
+    opts->fault_latency = -1;
+    opts->access_model = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        // options without a value
+        if (strcmp(argv[i], "-s") == 0) {
+            opts->summary = 1;
+            continue;
         }
-        if(running && running->rem_time == 0){
-            // for processses are finished at the start of this quantum
-            printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", time_stamp, running->pname, q_size(ready_q));
-            running->complete_time = time_stamp;
-            free_memory(running, memory); 
-            running = NULL;
+        if (strcmp(argv[i], "--sweep") == 0) {
+            opts->sweep = 1;
+            continue;
         }
-        if(!isEmpty(ready_q)){
-            // run a process from ready queue
-            if(running) enqueue(ready_q, running);
-            running = dequeue(ready_q);
-            
-            while(running->addr == NULL){
-                if(first_fit_allocate(running, memory) == -1){
-                    enqueue(ready_q, running);
-                    running = dequeue(ready_q);
-                }
+        if (strcmp(argv[i], "--compact") == 0) {
+            opts->compact = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "--stats") == 0) {
+#ifdef NO_STATS
+            fprintf(stderr, "This build has no counters, --stats is not available.\n");
+            exit(EXIT_FAILURE);
+#endif
+            opts->stats = 1;
+            continue;
+        }
+        if (i + 1 == argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+        char *option = argv[i], *value = argv[++i];
+        if (strcmp(option, "-f") == 0) {
+            opts->filename = value;
+            opts->stream = strcmp(value, "-") == 0;
+        } else if (strcmp(option, "-m") == 0) {
+            opts->method = value;
+            int m = 0;
+            while (m < METHOD_NUMBER && strcmp(value, methods[m]) != 0) m++;
+            if (m == METHOD_NUMBER) {
+                fprintf(stderr, "Invalid memory allocation method: %s\n", opts->method);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(option, "-q") == 0) {
+            opts->quantum = atoi(value);
+            if (opts->quantum < 1 || opts->quantum > MAX_QUANTUM) {
+                fprintf(stderr, "Invalid quality value: %d. Must be 1, 2, or 3.\n", opts->quantum);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(option, "-S") == 0) {
+            if (strcmp(value, "rr") == 0) opts->scheduler = RR;
+            else if (strcmp(value, "srtf") == 0) opts->scheduler = SRTF;
+            else if (strcmp(value, "mlfq") == 0) opts->scheduler = MLFQ;
+            else {
+                fprintf(stderr, "Invalid scheduler: %s\n", value);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(option, "-c") == 0) {
+            opts->cpus = read_size(option, value);
+            if (opts->cpus > MAX_CPUS) {
+                fprintf(stderr, "Invalid value for -c: %s. At most %d CPUs.\n", value, MAX_CPUS);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(option, "-p") == 0) {
+            if (strcmp(value, "lru") == 0) opts->policy = LRU;
+            else if (strcmp(value, "clock") == 0) opts->policy = CLOCK;
+            else if (strcmp(value, "second-chance") == 0) opts->policy = SECOND_CHANCE;
+            else if (strcmp(value, "lfu") == 0) opts->policy = LFU;
+            else if (strcmp(value, "working-set") == 0) opts->policy = WORKING_SET;
+            else {
+                fprintf(stderr, "Invalid page replacement policy: %s\n", value);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(option, "-A") == 0) {
+            opts->access = value;
+        } else if (strcmp(option, "-L") == 0) {
+            char *end;
+            opts->fault_latency = strtoll(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || opts->fault_latency < 0 || opts->fault_latency > INT_MAX) {
+                fprintf(stderr, "Invalid value for -L: %s\n", value);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(option, "-b") == 0) {
+            opts->trace = value;
+        } else if (strcmp(option, "--checkpoint") == 0) {
+            opts->checkpoint = value;
+        } else if (strcmp(option, "--at") == 0) {
+            char *end;
+            opts->checkpoint_at = strtoll(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || opts->checkpoint_at < 0 || opts->checkpoint_at == LLONG_MAX) {
+                fprintf(stderr, "Invalid value for --at: %s\n", value);
+                exit(EXIT_FAILURE);
             }
-            
-            printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,allocated-at=%d\n", time_stamp, running->pname, running->rem_time, memory_usage(memory), running->addr->start);
+        } else if (strcmp(option, "--resume") == 0) {
+            opts->resume = value;
+        } else if (strcmp(option, "-M") == 0) {
+            opts->memory_size = read_size(option, value);
+        } else if (strcmp(option, "-F") == 0) {
+            opts->frame_number = read_size(option, value);
+        } else if (strcmp(option, "-P") == 0) {
+            opts->page_size = read_size(option, value);
+        } else {
+            fprintf(stderr, "Invalid argument: %s\n", option);
+            exit(EXIT_FAILURE);
         }
+    }
 
-        time_stamp += quantum;
-        if(running) running->rem_time = running->rem_time - quantum;
-        if(running && running->rem_time < 0) running->rem_time = 0;
-        rem_p = remaining_p(proc_list, p_cnt); // check how many processes are not finished
-        if(rem_p == 0){
-            // if the last process is finished at this timestamp
-            printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", time_stamp, running->pname, q_size(ready_q));
-            running->complete_time = time_stamp;
+    // a sweep runs every method and quantum that is not given, a resumed run those of its snapshot
+    if (!opts->filename || (!opts->sweep && !opts->resume && (!opts->method || !opts->quantum))) {
+        fprintf(stderr, "Missing required arguments.\n");
+        exit(EXIT_FAILURE);
+    }
+    if ((opts->checkpoint == NULL) != (opts->checkpoint_at == -1)) {
+        fprintf(stderr, "--checkpoint and --at must be given together.\n");
+        exit(EXIT_FAILURE);
+    }
+    if ((opts->checkpoint || opts->resume) && (opts->sweep || opts->trace)) {
+        fprintf(stderr, "Checkpoints do not apply to --sweep or -b.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opts->stream && (opts->sweep || opts->trace || opts->checkpoint || opts->resume)) {
+        fprintf(stderr, "Reading processes from stdin does not apply to --sweep, -b or checkpoints.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opts->stats && opts->sweep) {
+        fprintf(stderr, "--stats does not apply to --sweep.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opts->policy != -1 && opts->method && strcmp(opts->method, "virtual") != 0) {
+        fprintf(stderr, "A page replacement policy only applies to -m virtual.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opts->compact && opts->method && !is_contiguous(opts->method)) {
+        fprintf(stderr, "Compaction only applies to -m first-fit, best-fit, next-fit and worst-fit.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opts->fault_latency != -1 && !opts->access) {
+        fprintf(stderr, "A fault latency only applies with -A.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opts->access) {
+        if (!opts->method || strcmp(opts->method, "virtual") != 0) {
+            fprintf(stderr, "Demand paging only applies to -m virtual.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (opts->sweep || opts->stream || opts->checkpoint || opts->resume) {
+            fprintf(stderr, "Demand paging does not apply to --sweep, checkpoints or reading processes from stdin.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (opts->fault_latency == -1) opts->fault_latency = FAULT_LATENCY;
+        opts->access_model = read_access_model(opts->access, opts->fault_latency);
+        if (opts->access_model == NULL) {
+            fprintf(stderr, "Invalid access model: %s\n", opts->access);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (opts->frame_number == -1) {
+        // unless given, frames cover the memory size
+        opts->frame_number = opts->memory_size / opts->page_size;
+        if (opts->frame_number < 1) {
+            fprintf(stderr, "Memory size %d is smaller than page size %d.\n", opts->memory_size, opts->page_size);
+            exit(EXIT_FAILURE);
         }
     }
-
-    free_all_memory(memory);
-    free_q(ready_q);
-    return time_stamp;
 }
 
 /**
- * Function to run paged algorithm, corresponding to task 3.
- * 
- * Return: the time stamp when all processes are finished.
+ * Function to load a whole trace file into memory. Regular files are mapped,
+ * anything else is read in large chunks into a growing buffer.
+ *
+ * Input:
+ * filename;
+ * len: set to the number of bytes loaded;
+ * mapped: set to 1 if the buffer is mapped, 0 if it has to be freed.
+ *
+ * Return: the trace, NULL if it is empty.
 */
-int paged(Process **proc_list, int p_cnt, int quantum) {
-    Queue *ready_q = initialize_q();
-
-    // create a frames list
-    Frame_track* frame_track = initialize_frame_track();
-
-    int time_stamp = 0;
-    int rem_p = p_cnt;
-    Process *running = NULL;
-
-    while(rem_p != 0){
-        // if proesses haven't finished
-        for(int i = 0; i < p_cnt; i++){
-            if(proc_list[i]->arr_time <= time_stamp && proc_list[i]->arr_time > time_stamp - quantum){
-                // for processes are arrived at this quantum, add them to queue
-                enqueue(ready_q, proc_list[i]);
-            }
-        }
-        if(running && running->rem_time == 0){
-            // for processses are finished at the start of this quantum
-            printf("%d,EVICTED,evicted-frames=[", time_stamp);
-            evict(running, frame_track, ceil((double)running->mem / PAGE_SIZE), 0);
-            printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", time_stamp, running->pname, q_size(ready_q));
-            running->complete_time = time_stamp;
-            running = NULL;
+static char* load_trace(char *filename, size_t *len, int *mapped){
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Cannot open %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    *len = 0;
+    *mapped = 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            close(fd);
+            return NULL;
         }
-        if(!isEmpty(ready_q)){ 
-            // run a process from ready queue
-            if(running) enqueue(ready_q, running);
-            running = dequeue(ready_q);
-
-            // check if running has space in frame_list
-            if (running->isInFrame == 0) {
-                while(insert(running, frame_track, 0) == -1){
-                    // find the LRU processes and evict all pages
-                    printf("%d,EVICTED,evicted-frames=[", time_stamp);
-                    Process *lru_proc = find_LRU_proc(ready_q);
-                    evict(lru_proc, frame_track, ceil((double)lru_proc->mem / PAGE_SIZE), 0); 
-                }
-            }  
-
-            int mem_usage = (int)ceil((double)(FRAME_NUMBER - frame_track->empty_frames) / FRAME_NUMBER * 100);
-            printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,mem-frames=[", time_stamp, running->pname, running->rem_time, mem_usage);
-
-            // print all frames of this running process
-            int pages_rem = ceil((double)running->mem / PAGE_SIZE);
-            for (int i=0; i<FRAME_NUMBER; i++) {
-                if (frame_track->frame_list[i] == running) {
-                    printf("%d", i);
-                    pages_rem --;
-                    if (pages_rem == 0) printf("]\n");
-                    else printf(",");
-                }
-            }
+        char *buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (buf != MAP_FAILED) {
+            madvise(buf, st.st_size, MADV_SEQUENTIAL);
+            close(fd);
+            *len = st.st_size;
+            *mapped = 1;
+            return buf;
         }
- 
-        time_stamp += quantum;
-        if(running) {running->rem_time = running->rem_time - quantum; running->last_used = time_stamp - quantum;}
-        if(running && running->rem_time < 0) running->rem_time = 0;
-        rem_p = remaining_p(proc_list, p_cnt); // check how many processes are not finished
-        if(rem_p == 0){
-            // if the last process is finished at this timestamp
-            printf("%d,EVICTED,evicted-frames=[", time_stamp);
-            evict(running, frame_track, ceil((double)running->mem / PAGE_SIZE), 0);
-            printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", time_stamp, running->pname, q_size(ready_q));
-            running->complete_time = time_stamp;
+    }
+
+    size_t cap = READ_CHUNK;
+    char *buf = (char*)malloc(cap);
+    ssize_t got;
+    while ((got = read(fd, buf + *len, cap - *len)) > 0) {
+        *len += got;
+        if (*len == cap) {
+            cap *= 2;
+            buf = (char*)realloc(buf, cap);
         }
-    }  
-    free_q(ready_q);
-    free_frame(frame_track);
-    return time_stamp;
+    }
+    close(fd);
+    return buf;
 }
 
 /**
- * Function to run virtual algorithm, corresponding to task 4.
+ * Function to read processes, change p_cnt as process counter.
+ * Each line holds arrival time, name, service time and memory separated by
+ * blanks. Records are taken from one slab that grows geometrically, and
+ * fields are parsed straight from the loaded trace.
  * 
- * Return: the time stamp when all processes are finished.
+ * Return: a process list.
 */
-int virtual(Process **proc_list, int p_cnt, int quantum) {
-    Queue *ready_q = initialize_q();
-
-    Frame_track* frame_track = initialize_frame_track();
-
-    int time_stamp = 0;
-    int rem_p = p_cnt;
-    Process *running = NULL;
+Process** read_process(int argc, char *argv[], Options *opts, int *p_cnt) {
+
+    // read file name, method, quantum and policy from command line
+    read_command(argc, argv, opts);
+    if (opts->stats) stats_start();
+    *p_cnt = 0;
+    if (opts->stream) {
+        // processes are read from stdin as they arrive, see open_stream
+        return (Process**)malloc(sizeof(Process*));
+    }
 
-    while(rem_p != 0){
-        // if proesses haven't finished
-        for(int i = 0; i < p_cnt; i++){
-            if(proc_list[i]->arr_time <= time_stamp && proc_list[i]->arr_time > time_stamp - quantum){
-                // for processes are arrived at this quantum, add them to queue
-                enqueue(ready_q, proc_list[i]);
-            }
-        }
-        if(running && running->rem_time == 0){
-            // for processses are finished at the start of this quantum
-            printf("%d,EVICTED,evicted-frames=[", time_stamp);
-            evict(running, frame_track, running->no_pageInFrames, 1);
-            printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", time_stamp, running->pname, q_size(ready_q));
-            running->complete_time = time_stamp;
-            running = NULL;
+    size_t len;
+    int mapped;
+    char *trace = load_trace(opts->filename, &len, &mapped);
+    const char *c = trace, *end = trace + len;
+
+    int cap = 0, line = 0;
+    Process *slab = NULL; // every process record
+
+    while (c < end) {
+        line++;
+        c = skip_blank(c, end);
+        if (c < end && *c == '\n') {
+            // skip blank lines
+            c++;
+            continue;
         }
-        if(!isEmpty(ready_q)){ 
-            // run a process from ready queue
-            if(running) enqueue(ready_q, running);
-            running = dequeue(ready_q); 
-            // check if the process has space in frame_list
-            if (running->isInFrame == 0) {
-                if (ceil((double)running->mem / PAGE_SIZE) <= MIN_RUNNING_PAGE) {
-                    // for processes which have less than or equal to 4 pages
-                    // insert all pages
- 
-                    while(insert(running, frame_track, 0) == -1){
-                        // find the LRU processes and evict needed pages
-                        printf("%d,EVICTED,evicted-frames=[", time_stamp);
-                        Process *lru_proc = find_LRU_proc(ready_q);
-                        evict(lru_proc, frame_track, ceil((double)running->mem / PAGE_SIZE) - frame_track->empty_frames, 1); 
-                    }
-                } else {
-                    // for processes having more than 4 pages
-                    while (insert(running, frame_track, 1) == -1) {
-                        // evict LRU processes' pages if less than min_running_page
-                        printf("%d,EVICTED,evicted-frames=[", time_stamp);
-                        Process *lru_proc = find_LRU_proc(ready_q);
-                        if (MIN_RUNNING_PAGE - frame_track->empty_frames >= lru_proc->no_pageInFrames) {
-                            evict(lru_proc, frame_track, lru_proc->no_pageInFrames, 1);
-                        } else {
-                            evict(lru_proc, frame_track, MIN_RUNNING_PAGE - frame_track->empty_frames, 1);
-                        }
-                    }
-                }
-            }
 
-            int mem_usage = ceil((double)(FRAME_NUMBER - frame_track->empty_frames) / FRAME_NUMBER * 100);
-            printf("%d,RUNNING,process-name=%s,remaining-time=%d,mem-usage=%d%%,mem-frames=[", time_stamp, running->pname, running->rem_time, mem_usage);
-            // print all frames of this running process
-            int pages_rem = running->no_pageInFrames; 
-            for (int i=0; i<FRAME_NUMBER; i++) {
-                if (frame_track->frame_list[i] == running) {
-                    printf("%d", i);
-                    pages_rem --;
-                    if (pages_rem == 0) printf("]\n");
-                    else printf(",");
-                }
-            }
+        long long t_arr, t_serv, mem;
+        char pname[MAX_NAME_LENGTH + 1];
+        if (parse_line(&c, end, &t_arr, pname, &t_serv, &mem) == -1) {
+            fprintf(stderr, "Invalid process on line %d of %s\n", line, opts->filename);
+            exit(EXIT_FAILURE);
         }
-  
-        time_stamp += quantum;
-        if(running) {running->rem_time = running->rem_time - quantum; running->last_used = time_stamp - quantum;}
-        if(running && running->rem_time < 0) running->rem_time = 0;
-        rem_p = remaining_p(proc_list, p_cnt); // check how many processes are not finished
-        if(rem_p == 0){
-            // if the last process is finished at this timestamp
-            printf("%d,EVICTED,evicted-frames=[", time_stamp);
-            evict(running, frame_track, running->no_pageInFrames, 1);
-            printf("%d,FINISHED,process-name=%s,proc-remaining=%d\n", time_stamp, running->pname, q_size(ready_q));
-            running->complete_time = time_stamp;
+        c++; // past the newline
+
+        if (*p_cnt == cap) {
+            cap = cap ? cap * 2 : PROCESS_CHUNK;
+            slab = (Process*)realloc(slab, sizeof(Process) * cap);
         }
+        initialize_p(&slab[*p_cnt], pname, t_arr, t_serv, (int)mem);
+        slab[*p_cnt].id = *p_cnt;
+        slab[*p_cnt].slot = *p_cnt;
+        (*p_cnt)++;
     }
-    free_q(ready_q);
-    free_frame(frame_track);
-    return time_stamp;
+
+    if (mapped) munmap(trace, len);
+    else free(trace);
+
+    // the slab no longer moves, so the process list can point into it
+    Process **proc_list = (Process**)malloc(sizeof(Process*) * (*p_cnt > 0 ? *p_cnt : 1));
+    for (int i = 0; i < *p_cnt; i++) proc_list[i] = &slab[i];
+    return proc_list;
 }
@@ -0,0 +1,78 @@
+#!/bin/sh
+# Performance suite, run by make bench.
+#
+# Usage: ./bench.sh [allocate binary ...]
+# Each binary given is timed on the large hidden cases, so an older build can
+# be compared against the current one. The makespan of every method on
+# task4/1000 is then shown for each number of CPUs given to -c. Last, every
+# engine of the count build (make count) runs on synthetic traces from
+# workload, reporting simulation events per second and peak RSS.
+#
+# SIZES, METHODS, QUANTUM, CPUS, LIMIT and BENCH_DIR override the defaults, and
+# WORKLOAD holds extra workload options, e.g. WORKLOAD="-a bursty".
+
+BINS=${*:-./allocate}
+SIZES=${SIZES:-1000 100000 10000000}
+METHODS=${METHODS:-infinite first-fit best-fit next-fit worst-fit buddy paged virtual}
+QUANTUM=${QUANTUM:-3}
+CPUS=${CPUS:-1 2 4 8}
+BENCH_DIR=${BENCH_DIR:-/tmp}
+
+run() {
+    start=$(date +%s.%N)
+    timeout "${LIMIT:-60}" "$@" > /dev/null
+    status=$?
+    end=$(date +%s.%N)
+    if [ $status -eq 124 ]; then echo "timeout"; else awk -v a="$start" -v b="$end" 'BEGIN { printf "%.3fs\n", b - a }'; fi
+}
+
+for bin in $BINS; do
+    echo "== $bin"
+    printf "%-40s %s\n" "task2/1000 q2 first-fit" "$(run $bin -f cases/hiddencases/task2/1000.txt -q 2 -m first-fit)"
+    printf "%-40s %s\n" "task3/1000 q2 paged" "$(run $bin -f cases/hiddencases/task3/1000.txt -q 2 -m paged)"
+    printf "%-40s %s\n" "task4/1000 q2 virtual" "$(run $bin -f cases/hiddencases/task4/1000.txt -q 2 -m virtual)"
+done
+
+echo "== makespan by CPUs, task4/1000 quantum $QUANTUM"
+for cpus in $CPUS; do
+    # a sweep runs every method, its last column is the makespan
+    timeout "${LIMIT:-60}" ./allocate --sweep -f cases/hiddencases/task4/1000.txt -q "$QUANTUM" -c "$cpus" |
+        awk -v c="$cpus" 'NR > 1 { print c, $1, $6 }'
+done | awk '
+    !($2 in seen) { seen[$2] = 1; order[++n] = $2 }
+    !($1 in col) { col[$1] = 1; cpus[++k] = $1 }
+    { span[$2, $1] = $3 }
+    END {
+        printf "%-10s", "method"
+        for (j = 1; j <= k; j++) printf " %8s", "-c " cpus[j]
+        printf "\n"
+        for (i = 1; i <= n; i++) {
+            printf "%-10s", order[i]
+            for (j = 1; j <= k; j++) printf " %8s", span[order[i], cpus[j]]
+            printf "\n"
+        }
+    }'
+
+if [ ! -x ./allocate-count ] || [ ! -x ./workload ]; then
+    echo "make count workload to run the engine suite"
+    exit 0
+fi
+
+echo "== engines, quantum $QUANTUM"
+printf "%-10s %10s %10s %14s %12s\n" "method" "processes" "seconds" "events/s" "peak RSS KB"
+for size in $SIZES; do
+    trace="$BENCH_DIR/allocate-workload-$size.txt"
+    [ -f "$trace" ] || ./workload -n "$size" $WORKLOAD > "$trace"
+    for m in $METHODS; do
+        # the count build reports on stderr, the summary goes to /dev/null
+        report=$(timeout "${LIMIT:-600}" ./allocate-count -s -f "$trace" -q "$QUANTUM" -m "$m" 2>&1 > /dev/null)
+        if [ $? -eq 124 ]; then
+            printf "%-10s %10s %10s\n" "$m" "$size" "timeout"
+            continue
+        fi
+        echo "$report" | awk -v m="$m" -v n="$size" '
+            /^simulation:/ { secs = $5; sub(/s,$/, "", secs); rate = $6 }
+            /^peak RSS:/ { rss = $3 }
+            END { printf "%-10s %10s %10s %14s %12s\n", m, n, secs, rate, rss }'
+    done
+done
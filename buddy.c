@@ -0,0 +1,207 @@
+#include "buddy.h"
+
+/**
+ * Function to find the order of the smallest block that holds a given size
+*/
+static int block_order(int size){
+    int order = 0;
+    while((1 << order) < size) order++;
+    return order;
+}
+
+/**
+ * Function to push a free block onto the free list of its order
+*/
+static void push_free(Buddy *b, int start, int order){
+    b->free_order[start] = order;
+    b->free_prev[start] = -1;
+    b->free_next[start] = b->free_head[order];
+    if(b->free_head[order] != -1) b->free_prev[b->free_head[order]] = start;
+    b->free_head[order] = start;
+}
+
+/**
+ * Function to unlink a free block from the free list of its order
+*/
+static void remove_free(Buddy *b, int start){
+    int order = b->free_order[start];
+    int prev = b->free_prev[start], next = b->free_next[start];
+    if(prev != -1) b->free_next[prev] = next;
+    else b->free_head[order] = next;
+    if(next != -1) b->free_prev[next] = prev;
+    b->free_order[start] = -1;
+}
+
+/**
+ * Function to initialize buddy memory. size is rounded down to a power of two.
+ *
+ * return: Buddy*
+*/
+Buddy* initialize_buddy(int size){
+    Buddy *b = (Buddy*)malloc(sizeof(Buddy));
+    b->max_order = 0;
+    while((2 << b->max_order) <= size) b->max_order++;
+    b->size = 1 << b->max_order;
+    b->used = 0;
+    b->free_head = (int*)malloc(sizeof(int) * (b->max_order + 1));
+    b->free_next = (int*)malloc(sizeof(int) * b->size);
+    b->free_prev = (int*)malloc(sizeof(int) * b->size);
+    b->free_order = (signed char*)malloc(b->size);
+    for(int i = 0; i <= b->max_order; i++) b->free_head[i] = -1;
+    for(int i = 0; i < b->size; i++) b->free_order[i] = -1;
+    push_free(b, 0, b->max_order);
+    return b;
+}
+
+/**
+ * Function to allocate a process to the smallest free power-of-two block that
+ * holds it, splitting larger blocks in halves until the block has the right order
+ *
+ * Input:
+ * process;
+ * buddy memory;
+ *
+ * return: 0 for success or -1 for failure
+*/
+int buddy_allocate(Process *p, Buddy *b){
+    int order = block_order(p->mem);
+    if(order > b->max_order) return -1;
+
+    int curr = order;
+    while(curr <= b->max_order && b->free_head[curr] == -1) curr++;
+    if(curr > b->max_order) return -1;
+
+    int start = b->free_head[curr];
+    remove_free(b, start);
+    while(curr > order){
+        // split, keeping the lower half and freeing the upper half
+        curr--;
+        push_free(b, start + (1 << curr), curr);
+    }
+
+    p->buddy_at = start;
+    b->used += 1 << order;
+    return 0;
+}
+
+/**
+ * Function to free the block of a process, merging it with its buddy for as
+ * long as the buddy is free and of the same order
+ *
+ * Input:
+ * process;
+ * buddy memory;
+*/
+void buddy_free(Process *p, Buddy *b){
+    int order = block_order(p->mem);
+    int start = p->buddy_at;
+    b->used -= 1 << order;
+
+    while(order < b->max_order){
+        int buddy = start ^ (1 << order);
+        if(b->free_order[buddy] != order) break;
+        remove_free(b, buddy);
+        if(buddy < start) start = buddy;
+        order++;
+    }
+    push_free(b, start, order);
+
+    p->buddy_at = -1;
+}
+
+/**
+ * Function to calculate memory usage, counting whole blocks held by processes
+ *
+ * Input:
+ * buddy memory;
+ *
+ * return: memory usage
+*/
+int buddy_usage(Buddy *b){
+    return ceil((double)b->used*100/b->size);
+}
+
+/**
+ * Function to find the size of the block a process of a given size is allocated
+ *
+ * return: block size, or more than the memory if no block holds it
+*/
+int buddy_block_size(Buddy *b, int mem){
+    if(mem > b->size) return b->size + 1;
+    return 1 << block_order(mem);
+}
+
+/**
+ * Function to find the size of the largest free block, the largest block
+ * buddy_allocate can give without freeing any
+ *
+ * return: block size, 0 if no block is free
+*/
+int buddy_room(Buddy *b){
+    for(int order = b->max_order; order >= 0; order--){
+        if(b->free_head[order] != -1) return 1 << order;
+    }
+    return 0;
+}
+
+/**
+ * Function to record the free blocks in a snapshot, order by order and in
+ * the order of each free list. Blocks held by processes are recorded with them.
+*/
+void snapshot_buddy(Buddy *b, Snapshot *s){
+    int cnt = 0;
+    for(int order = 0; order <= b->max_order; order++){
+        for(int start = b->free_head[order]; start != -1; start = b->free_next[start]) cnt++;
+    }
+    s->blocks = (Snapshot_block*)malloc(sizeof(Snapshot_block) * (cnt > 0 ? cnt : 1));
+    cnt = 0;
+    for(int order = 0; order <= b->max_order; order++){
+        for(int start = b->free_head[order]; start != -1; start = b->free_next[start]){
+            s->blocks[cnt].start = start;
+            s->blocks[cnt].size = 1 << order;
+            s->blocks[cnt].pid = -1;
+            cnt++;
+        }
+    }
+    s->header->block_cnt = cnt;
+}
+
+/**
+ * Function to rebuild buddy memory fresh from initialize_buddy with the free
+ * blocks of a snapshot, keeping the order of every free list
+ *
+ * return: 0 for success or -1 if a free block or a block of a process does not fit the memory
+*/
+int restore_buddy(Buddy *b, Snapshot *s, Process **proc_list){
+    for(int i = 0; i < s->header->p_cnt; i++){
+        Process *p = proc_list[i];
+        if(p->buddy_at == -1) continue;
+        if(p->mem > b->size || p->buddy_at >= b->size || p->buddy_at % (1 << block_order(p->mem)) != 0) return -1;
+    }
+    for(int c = 0; c < s->header->cpus; c++){
+        if(s->running[c] != -1 && proc_list[s->running[c]]->buddy_at == -1) return -1;
+    }
+    remove_free(b, 0);
+    b->used = b->size;
+    // push_free adds to the front, so push each list from its back
+    for(int i = s->header->block_cnt - 1; i >= 0; i--){
+        Snapshot_block *r = &s->blocks[i];
+        if(r->size < 1 || r->size > b->size || r->start < 0 || r->start >= b->size) return -1;
+        int order = block_order(r->size);
+        if(r->size != 1 << order || r->start % r->size != 0 || b->free_order[r->start] != -1) return -1;
+        push_free(b, r->start, order);
+        b->used -= r->size;
+    }
+    return 0;
+}
+
+/**
+ * Function to free buddy memory
+*/
+void free_buddy(Buddy *b){
+    free(b->free_head);
+    free(b->free_next);
+    free(b->free_prev);
+    free(b->free_order);
+    free(b);
+}
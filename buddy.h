@@ -0,0 +1,38 @@
+#ifndef BUDDY_H
+#define BUDDY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "process_q.h"
+#include "snapshot.h"
+
+typedef struct Buddy{
+    int size; // size of memory, a power of two
+    int max_order; // order of the whole memory, size = 2^max_order
+    int used; // total size of blocks allocated to processes
+    int *free_head; // for each order, the start of the first free block, -1 if there is none
+    int *free_next; // for each free block start, the start of the next free block of the same order
+    int *free_prev; // for each free block start, the start of the previous free block of the same order
+    signed char *free_order; // for each address, the order of the free block starting there, -1 otherwise
+} Buddy;
+
+Buddy* initialize_buddy(int size);
+
+int buddy_allocate(Process *p, Buddy *b);
+
+void buddy_free(Process *p, Buddy *b);
+
+int buddy_usage(Buddy *b);
+
+int buddy_block_size(Buddy *b, int mem);
+
+int buddy_room(Buddy *b);
+
+void snapshot_buddy(Buddy *b, Snapshot *s);
+
+int restore_buddy(Buddy *b, Snapshot *s, Process **proc_list);
+
+void free_buddy(Buddy *b);
+
+#endif
@@ -0,0 +1,304 @@
+#include "engine.h"
+
+/**
+ * Function to count the quanta until the next time stamp where something
+ * happens: a process arrives, a running process finishes or the scheduler may
+ * switch a CPU to another process. Quantum boundaries in between produce no
+ * events, so the engines can skip them.
+ *
+ * Return: number of quanta to advance (at least 1).
+*/
+int next_event(Arrival_cursor *arrivals, Ready *ready, Process **running, int cpus, long long time_stamp, int quantum){
+    long long steps = -1;
+    for(int c = 0; c < cpus; c++){
+        // quanta until the scheduler switches on its own, 1 while processes wait under RR
+        long long cpu_steps = ready_horizon(ready, running[c]);
+        if(cpu_steps == 1) return 1;
+        if(cpu_steps != -1 && (steps == -1 || cpu_steps < steps)) steps = cpu_steps;
+        if(running[c] && running[c]->rem_time > 0){
+            // quanta until the process running on this CPU finishes
+            long long fin_steps = (running[c]->rem_time + quantum - 1) / quantum;
+            if(steps == -1 || fin_steps < steps) steps = fin_steps;
+        }
+    }
+    long long arr = next_arrival(arrivals);
+    if(arr != -1){
+        // quanta until the quantum boundary where the next process is enqueued
+        long long arr_steps = (arr - time_stamp + quantum - 1) / quantum;
+        if(steps == -1 || arr_steps < steps) steps = arr_steps;
+    }
+    if(steps < 1 || steps > INT_MAX) return steps < 1 ? 1 : INT_MAX;
+    return (int)steps;
+}
+
+/**
+ * Function to allocate a process to contiguous memory unless it already is,
+ * compacting memory first if that makes room for it
+ *
+ * Return: 0 for success or -1 if no hole fits it
+*/
+static int contiguous_admit(Memory *m, Process *p, long long time_stamp){
+    if(p->addr != NULL) return 0;
+    if(!compaction_fits(m, p)) return fit_allocate(p, m, m->fit);
+    int fragmentation = memory_fragmentation(m);
+    log_compacted(time_stamp, compact_memory(m), fragmentation);
+    return fit_allocate(p, m, m->fit);
+}
+
+/**
+ * Function to allocate a process a buddy block unless it already has one
+ *
+ * Return: 0 for success or -1 if no block fits it
+*/
+static int buddy_admit(Buddy *b, Process *p){
+    if(p->buddy_at != -1) return 0;
+    return buddy_allocate(p, b);
+}
+
+/**
+ * Function to load all pages of a process into frames unless they are,
+ * evicting every page of least recently used processes until they fit
+ *
+ * Return: 0 for success or -1 if the other pages belong to running processes
+*/
+static int paged_admit(Frame_track *track, Process *p, long long time_stamp){
+    if(p->isInFrame == 1) return 0;
+    while(insert(p, track, 0) == -1){
+        // find the LRU processes and evict all pages
+        Process *lru_proc = find_LRU_proc(track, p);
+        if(lru_proc == NULL) return -1;
+        log_evicted(time_stamp);
+        evict_victim(lru_proc, track, page_count(track, lru_proc->mem), 0);
+    }
+    return 0;
+}
+
+/**
+ * Function to load pages of a process into frames unless enough are, evicting
+ * pages chosen by the page replacement policy until they fit
+ *
+ * Return: 0 for success or -1 if the other pages belong to running processes
+*/
+static int virtual_admit(Frame_track *track, Process *p, long long time_stamp){
+    if(p->isInFrame == 1) return 0;
+    if(page_count(track, p->mem) <= MIN_RUNNING_PAGE){
+        // for processes which have less than or equal to 4 pages
+        // insert all pages
+        while(insert(p, track, 0) == -1){
+            // find the LRU processes and evict needed pages
+            if(track->policy != LRU){
+                if(evict_pages(track, p, page_count(track, p->mem) - track->empty_frames, time_stamp) == 0) return -1;
+                continue;
+            }
+            Process *lru_proc = find_LRU_proc(track, p);
+            if(lru_proc == NULL) return -1;
+            log_evicted(time_stamp);
+            evict_victim(lru_proc, track, page_count(track, p->mem) - track->empty_frames, 1);
+        }
+    }else{
+        // for processes having more than 4 pages
+        while(insert(p, track, 1) == -1){
+            // evict LRU processes' pages if less than min_running_page
+            if(track->policy != LRU){
+                if(evict_pages(track, p, MIN_RUNNING_PAGE - track->empty_frames, time_stamp) == 0) return -1;
+                continue;
+            }
+            Process *lru_proc = find_LRU_proc(track, p);
+            if(lru_proc == NULL) return -1;
+            log_evicted(time_stamp);
+            if(MIN_RUNNING_PAGE - track->empty_frames >= lru_proc->no_pageInFrames){
+                evict_victim(lru_proc, track, lru_proc->no_pageInFrames, 1);
+            }else{
+                evict_victim(lru_proc, track, MIN_RUNNING_PAGE - track->empty_frames, 1);
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Function to note that a process in frames ran for elapsed, or until it
+ * finished, up to the quantum starting at time_stamp. Under demand paging it
+ * touches its pages, and the page faults add to its remaining time.
+*/
+static void frames_touch(Frame_track *track, Process *p, long long time_stamp, long long elapsed){
+    p->last_used = time_stamp;
+    if(track->access) p->rem_time += access_pages(track, p, elapsed, time_stamp);
+    touch(p, track);
+}
+
+/**
+ * Function to count the frames a process may be given: every frame except
+ * those holding pages of processes running on other CPUs
+*/
+static int frames_room(Frame_track *track, Process **running, int cpus){
+    int room = track->frame_number;
+    for(int c = 0; c < cpus; c++) if(running[c]) room -= running[c]->no_pageInFrames;
+    return room;
+}
+
+// task 1: memory is never short
+#define ENGINE run_infinite
+#define MEM_T void
+#define MEM_ADMIT(m, p, t) 0
+#define MEM_RELEASE(m, p, t)
+#define MEM_TOUCH(m, p, t, elapsed)
+#define MEM_REPORT(m, p, t) log_running(t, p)
+#define MEM_SAVE(m, s)
+#define MEM_LOAD(m, s, l) 0
+#define MEM_DEMAND(m, p) 0
+#define MEM_ROOM(m, r, n) 0
+#define MEM_FITS(m, p) 1
+#include "engine_loop.h"
+
+// task 2: contiguous memory with a fit strategy
+#define ENGINE run_contiguous
+#define MEM_T Memory
+#define MEM_ADMIT(m, p, t) contiguous_admit(m, p, t)
+#define MEM_RELEASE(m, p, t) free_memory(p, m)
+#define MEM_TOUCH(m, p, t, elapsed)
+#define MEM_REPORT(m, p, t) log_running_at(t, p, memory_usage(m), (p)->addr->start)
+#define MEM_SAVE(m, s) snapshot_memory(m, s)
+#define MEM_LOAD(m, s, l) restore_memory(m, s, l)
+#define MEM_DEMAND(m, p) ((p)->addr ? 0 : (p)->mem > 0 ? (p)->mem : 1)
+#define MEM_ROOM(m, r, n) memory_room(m)
+#define MEM_FITS(m, p) ((p)->mem <= (m)->size)
+#include "engine_loop.h"
+
+// buddy system over the same memory as task 2
+#define ENGINE run_buddy
+#define MEM_T Buddy
+#define MEM_ADMIT(m, p, t) buddy_admit(m, p)
+#define MEM_RELEASE(m, p, t) buddy_free(p, m)
+#define MEM_TOUCH(m, p, t, elapsed)
+#define MEM_REPORT(m, p, t) log_running_at(t, p, buddy_usage(m), (p)->buddy_at)
+#define MEM_SAVE(m, s) snapshot_buddy(m, s)
+#define MEM_LOAD(m, s, l) restore_buddy(m, s, l)
+#define MEM_DEMAND(m, p) ((p)->buddy_at != -1 ? 0 : buddy_block_size(m, (p)->mem))
+#define MEM_ROOM(m, r, n) buddy_room(m)
+#define MEM_FITS(m, p) ((p)->mem <= (m)->size)
+#include "engine_loop.h"
+
+// task 3: every page of a running process is in frames
+#define ENGINE run_paged
+#define MEM_T Frame_track
+#define MEM_ADMIT(m, p, t) paged_admit(m, p, t)
+#define MEM_RELEASE(m, p, t) (log_evicted(t), evict(p, m, page_count(m, (p)->mem), 0))
+#define MEM_TOUCH(m, p, t, elapsed) frames_touch(m, p, t, elapsed)
+#define MEM_REPORT(m, p, t) (log_running_frames(t, p, frame_usage(m)), print_frames(p, page_count(m, (p)->mem)))
+#define MEM_SAVE(m, s) snapshot_frames(m, s)
+#define MEM_LOAD(m, s, l) restore_frames(m, s, l)
+#define MEM_DEMAND(m, p) page_count(m, (p)->mem)
+#define MEM_ROOM(m, r, n) frames_room(m, r, n)
+#define MEM_FITS(m, p) (page_count(m, (p)->mem) <= (m)->frame_number)
+#include "engine_loop.h"
+
+// task 4: a running process needs MIN_RUNNING_PAGE pages in frames
+#define ENGINE run_virtual
+#define MEM_T Frame_track
+#define MEM_ADMIT(m, p, t) virtual_admit(m, p, t)
+#define MEM_RELEASE(m, p, t) (log_evicted(t), evict(p, m, (p)->no_pageInFrames, 1))
+#define MEM_TOUCH(m, p, t, elapsed) frames_touch(m, p, t, elapsed)
+#define MEM_REPORT(m, p, t) (log_running_frames(t, p, frame_usage(m)), print_frames(p, (p)->no_pageInFrames))
+#define MEM_SAVE(m, s) snapshot_frames(m, s)
+#define MEM_LOAD(m, s, l) restore_frames(m, s, l)
+#define MEM_DEMAND(m, p) 0
+#define MEM_ROOM(m, r, n) 0
+#define MEM_FITS(m, p) (page_count(m, (p)->mem) <= (m)->frame_number || MIN_RUNNING_PAGE <= (m)->frame_number)
+#include "engine_loop.h"
+
+/**
+ * Function to give the table the frames and the ready processes find the
+ * processes of a run in: the records of the stream, or else list filled in
+ * with the process list
+*/
+static Process_table* run_table(Process_table *list, Process **proc_list, int p_cnt, Process_stream *stream){
+    if(stream) return &stream->table;
+    list->at = proc_list;
+    list->cnt = p_cnt;
+    return list;
+}
+
+/**
+ * Function to run infinite algorithm, corresponding to task 1.
+ *
+ * Return: the time stamp when all processes are finished.
+*/
+long long infinite(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream) {
+    Process_table list;
+    return run_infinite(proc_list, p_cnt, run_table(&list, proc_list, p_cnt, stream), quantum, scheduler, cpus, NULL, ck, stream);
+}
+
+/**
+ * Function to run contiguous allocation, corresponding to task 2.
+ * fit selects the hole: FIRST_FIT (task 2), BEST_FIT, NEXT_FIT or WORST_FIT;
+ * compact is 1 to compact memory when no hole fits a process but the free
+ * memory does, with the compaction counts returned through stats.
+ *
+ * Return time stamp when all processes are finished
+*/
+long long contiguous(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream, int fit, int memory_size, int compact, Compact_stats *stats){
+    Memory *memory = initialize_memory(memory_size, fit);
+    memory->compact = compact;
+    Process_table list;
+    long long time_stamp = run_contiguous(proc_list, p_cnt, run_table(&list, proc_list, p_cnt, stream), quantum, scheduler, cpus, memory, ck, stream);
+    *stats = memory->stats;
+    free_all_memory(memory);
+    return time_stamp;
+}
+
+/**
+ * Function to run buddy system allocation over the same memory size as task 2,
+ * rounded down to a power of two
+ *
+ * Return time stamp when all processes are finished
+*/
+long long buddy(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream, int memory_size){
+    Buddy *memory = initialize_buddy(memory_size);
+    Process_table list;
+    long long time_stamp = run_buddy(proc_list, p_cnt, run_table(&list, proc_list, p_cnt, stream), quantum, scheduler, cpus, memory, ck, stream);
+    free_buddy(memory);
+    return time_stamp;
+}
+
+/**
+ * Function to run paged algorithm, corresponding to task 3.
+ *
+ * Return: the time stamp when all processes are finished.
+*/
+long long paged(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream, int frame_number, int page_size) {
+    Process_table list;
+    Frame_track* frame_track = initialize_frame_track(frame_number, page_size, LRU, run_table(&list, proc_list, p_cnt, stream));
+    long long time_stamp = run_paged(proc_list, p_cnt, frame_track->procs, quantum, scheduler, cpus, frame_track, ck, stream);
+    STAT_ADD(evictions, frame_track->stats.evictions);
+    STAT_ADD(refaults, frame_track->stats.refaults);
+    free_frame(frame_track);
+    return time_stamp;
+}
+
+/**
+ * Function to run virtual algorithm, corresponding to task 4.
+ * policy selects the page replacement policy, LRU for task 4;
+ * access models the pages running processes touch, NULL to leave them unmodelled;
+ * eviction and refault counts are returned through stats.
+ *
+ * Return: the time stamp when all processes are finished.
+*/
+long long virtual(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream, int frame_number, int page_size, int policy, Access_model *access, Page_stats *stats) {
+    Process_table list;
+    Frame_track* frame_track = initialize_frame_track(frame_number, page_size, policy, run_table(&list, proc_list, p_cnt, stream));
+    if(access){
+        frame_track->access = access;
+        frame_track->frame_page = (int*)malloc(sizeof(int) * frame_number);
+        if(policy == LRU){
+            frame_track->touch_next = (int*)malloc(sizeof(int) * frame_number);
+            frame_track->touch_prev = (int*)malloc(sizeof(int) * frame_number);
+        }
+    }
+    long long time_stamp = run_virtual(proc_list, p_cnt, frame_track->procs, quantum, scheduler, cpus, frame_track, ck, stream);
+    *stats = frame_track->stats;
+    STAT_ADD(evictions, frame_track->stats.evictions);
+    STAT_ADD(refaults, frame_track->stats.refaults);
+    free_frame(frame_track);
+    return time_stamp;
+}
@@ -0,0 +1,30 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "process_q.h"
+#include "memory.h"
+#include "frame.h"
+#include "buddy.h"
+#include "output.h"
+#include "sched.h"
+#include "snapshot.h"
+#include "stream.h"
+#include "stats.h"
+#include "paging.h"
+
+long long infinite(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream);
+
+long long contiguous(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream, int fit, int memory_size, int compact, Compact_stats *stats);
+
+long long buddy(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream, int memory_size);
+
+long long paged(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream, int frame_number, int page_size);
+
+long long virtual(Process **proc_list, int p_cnt, int quantum, int scheduler, int cpus, Checkpoint *ck, Process_stream *stream, int frame_number, int page_size, int policy, Access_model *access, Page_stats *stats);
+
+int next_event(Arrival_cursor *arrivals, Ready *ready, Process **running, int cpus, long long time_stamp, int quantum);
+
+#endif
@@ -0,0 +1,183 @@
+/**
+ * Scheduling loop shared by every memory allocation method, running the
+ * processes the scheduler picks from the ready processes on each of cpus CPUs
+ * at each quantum boundary. The CPUs share the memory manager, which never
+ * evicts a process running on another CPU. This file has no include guard:
+ * it is included once per memory manager, after defining
+ *
+ * ENGINE: name of the function to generate;
+ * MEM_T: type of the memory manager state;
+ * MEM_ADMIT(m, p, t): make p resident before it runs at time stamp t,
+ * 0 for success or -1 to try the next ready process instead;
+ * MEM_DEMAND(m, p): memory p needs before it can run, 0 if it can as it is;
+ * MEM_ROOM(m, r, n): the largest demand MEM_ADMIT may meet while the n CPUs run
+ * the processes r, so ready processes needing more are passed over untried;
+ * MEM_FITS(m, p): 1 if p fits once no other process holds memory;
+ * MEM_RELEASE(m, p, t): free the memory of p when it finishes at t;
+ * MEM_TOUCH(m, p, t, elapsed): note that p ran for elapsed, or until it
+ * finished, in the quanta up to the one starting at t, adding any time it
+ * stalled to its remaining time before that is charged;
+ * MEM_REPORT(m, p, t): log p starting to run at t;
+ * MEM_SAVE(m, s): add the sections of the memory manager to snapshot s;
+ * MEM_LOAD(m, s, l): restore them from s for process list l, 0 for success or -1.
+ *
+ * The hooks are expanded in place, so each memory manager gets its own
+ * copy of the loop with no indirect calls. They are undefined at the end.
+ *
+ * procs finds the processes by slot: the process list, or the records of the
+ * stream.
+ *
+ * Given a checkpoint, the run stops at the first quantum boundary at or
+ * after ck->at and is saved to a snapshot, or it resumes from ck->resume.
+ * Given a stream, processes are read from it as they arrive instead of
+ * proc_list, and released to it as they finish.
+ *
+ * With --stats the loop is timed as the schedule phase, switching to the
+ * arrival, allocation and output phases around the hooks.
+ *
+ * Return: the time stamp when all processes are finished
+*/
+static long long ENGINE(Process **proc_list, int p_cnt, Process_table *procs, int quantum, int scheduler, int cpus, MEM_T *mem, Checkpoint *ck, Process_stream *stream){
+
+    // initialize the processes in ready state, ordered by the scheduler
+    Ready *ready = initialize_ready(scheduler, procs);
+
+    long long time_stamp = 0;
+    int rem_p = p_cnt;
+    // process running on each CPU, NULL while the CPU is idle
+    Process **running = (Process**)calloc(cpus, sizeof(Process*));
+    Arrival_cursor *arrivals;
+    if(ck && ck->resume){
+        // continue from the quantum boundary the snapshot was taken at
+        arrivals = resume_run(ck->resume, proc_list, p_cnt, quantum, &time_stamp, &rem_p, running);
+        if(MEM_LOAD(mem, ck->resume, proc_list) == -1){
+            fprintf(stderr, "The snapshot does not match the memory of %s\n", ck->settings.method);
+            exit(EXIT_FAILURE);
+        }
+        // their demand depends on the memory just restored
+        for(int i = 0; i < ck->resume->header->ready_cnt; i++){
+            Process *p = proc_list[ck->resume->ready[i]];
+            ready_add(ready, p, MEM_DEMAND(mem, p));
+        }
+    }else if(stream){
+        arrivals = stream_arrivals(stream);
+    }else{
+        arrivals = initialize_arrivals(proc_list, p_cnt, quantum);
+    }
+
+    // processes of a stream are only counted once they are read
+    while(rem_p != 0 || next_arrival(arrivals) != -1){
+        if(ck && ck->at != -1 && time_stamp >= ck->at){
+            // save the run at this quantum boundary and stop
+            Snapshot *snapshot = save_run(ck, proc_list, p_cnt, time_stamp, rem_p, ready, running, arrivals);
+            MEM_SAVE(mem, snapshot);
+            if(write_snapshot(ck->path, snapshot) == -1){
+                fprintf(stderr, "Cannot write %s\n", ck->path);
+                exit(EXIT_FAILURE);
+            }
+            free_snapshot(snapshot);
+            ck->saved = 1;
+            break;
+        }
+        // if proesses haven't finished
+        // for processes are arrived at this quantum, add them to queue
+        STAT_PHASE(PHASE_ARRIVAL);
+        Process *arrival;
+        while((arrival = take_arrival(arrivals, time_stamp)) != NULL){
+            if(!MEM_FITS(mem, arrival)){
+                // it would wait for room forever
+                fprintf(stderr, "Process %s needs more memory than there is\n", arrival->pname);
+                exit(EXIT_FAILURE);
+            }
+            ready_add(ready, arrival, MEM_DEMAND(mem, arrival));
+            if(stream) rem_p++;
+        }
+        STAT_PHASE(PHASE_SCHEDULE);
+        for(int c = 0; c < cpus; c++){
+            if(running[c] && running[c]->rem_time == 0){
+                // for processses are finished at the start of this quantum
+                STAT_PHASE(PHASE_ALLOCATION);
+                MEM_RELEASE(mem, running[c], time_stamp);
+                STAT_PHASE(PHASE_OUTPUT);
+                log_finished(time_stamp, running[c], ready_size(ready));
+                STAT_PHASE(PHASE_SCHEDULE);
+                running[c]->complete_time = time_stamp;
+                running[c]->cpu = -1;
+                if(stream) stream_release(stream, running[c]);
+                running[c] = NULL;
+            }
+        }
+        for(int c = 0; c < cpus; c++){
+            if(!ready_preempts(ready, running[c])) continue;
+            // run the process the scheduler picks on this CPU
+            if(running[c]){
+                running[c]->cpu = -1;
+                ready_add(ready, running[c], MEM_DEMAND(mem, running[c]));
+                running[c] = NULL;
+            }
+            // processes needing more than the other CPUs leave are set aside untried
+            int room = MEM_ROOM(mem, running, cpus);
+            running[c] = ready_take(ready, room);
+            STAT_PHASE(PHASE_ALLOCATION);
+            while(running[c] && MEM_ADMIT(mem, running[c], time_stamp) == -1){
+                // no room for it yet, try the next ready process
+                ready_set_aside(ready, running[c], MEM_DEMAND(mem, running[c]));
+                running[c] = ready_take(ready, room);
+            }
+            STAT_PHASE(PHASE_OUTPUT);
+            if(running[c]){
+                running[c]->cpu = c;
+                MEM_REPORT(mem, running[c], time_stamp);
+            }
+            STAT_PHASE(PHASE_SCHEDULE);
+        }
+        // processes passed over wait for the next quantum boundary
+        ready_restore(ready);
+
+        // jump to the next quantum boundary where an event happens
+        long long elapsed = (long long)next_event(arrivals, ready, running, cpus, time_stamp, quantum) * quantum;
+        time_stamp += elapsed;
+        for(int c = 0; c < cpus; c++){
+            Process *p = running[c];
+            if(p == NULL) continue;
+            // a page fault may keep a process that would finish by the boundary running
+            MEM_TOUCH(mem, p, time_stamp - quantum, elapsed);
+            // update remaining time of the process running on this CPU
+            p->rem_time = p->rem_time - elapsed;
+            ready_ran(ready, p, elapsed / quantum);
+            if(p->rem_time < 0) p->rem_time = 0;
+            if(p->rem_time == 0) rem_p--; // the process has just finished
+        }
+        if(rem_p == 0 && next_arrival(arrivals) == -1){
+            // if the last processes are finished at this timestamp
+            for(int c = 0; c < cpus; c++){
+                if(running[c] == NULL) continue;
+                STAT_PHASE(PHASE_ALLOCATION);
+                MEM_RELEASE(mem, running[c], time_stamp);
+                STAT_PHASE(PHASE_OUTPUT);
+                log_finished(time_stamp, running[c], ready_size(ready));
+                STAT_PHASE(PHASE_SCHEDULE);
+                running[c]->complete_time = time_stamp;
+                running[c]->cpu = -1;
+                if(stream) stream_release(stream, running[c]);
+            }
+        }
+    }
+
+    free(running);
+    free_ready(ready);
+    free_arrivals(arrivals);
+    return time_stamp;
+}
+
+#undef ENGINE
+#undef MEM_T
+#undef MEM_ADMIT
+#undef MEM_RELEASE
+#undef MEM_TOUCH
+#undef MEM_REPORT
+#undef MEM_SAVE
+#undef MEM_LOAD
+#undef MEM_DEMAND
+#undef MEM_ROOM
+#undef MEM_FITS
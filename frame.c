@@ -1,81 +1,985 @@
 #include "frame.h"
+#include "paging.h"
 
 /**
  * Function to initialize frame track for task 3 and task 4
  *
+ * Input:
+ * frame_number: number of frames;
+ * page_size: page and frame size;
+ * policy: page replacement policy;
+ * procs: the processes of the run by slot.
+ *
  * Return: frame track
 */
-Frame_track* initialize_frame_track() {
+Frame_track* initialize_frame_track(int frame_number, int page_size, int policy, Process_table *procs) {
     Frame_track* frame_track = (Frame_track*)malloc(sizeof(Frame_track));
-    frame_track->empty_frames = FRAME_NUMBER;
-    for (int i=0; i<FRAME_NUMBER; i++) {
-        frame_track->frame_list[i] = NULL;
+    frame_track->frame_number = frame_number;
+    frame_track->page_size = page_size;
+    frame_track->map_words = (frame_number + 63) / 64;
+    frame_track->free_hint = 0;
+    frame_track->owner = (unsigned int*)calloc(frame_number, sizeof(unsigned int));
+    frame_track->procs = procs;
+    frame_track->free_map = (unsigned long long*)malloc(sizeof(unsigned long long) * frame_track->map_words);
+    frame_track->stray_map = (unsigned long long*)calloc(frame_track->map_words, sizeof(unsigned long long));
+    frame_track->stray_hint = 0;
+    frame_track->stray_cnt = 0;
+    frame_track->scratch = (int*)malloc(sizeof(int) * frame_number);
+    frame_track->empty_frames = frame_number;
+    frame_track->lru_head = -1;
+    frame_track->lru_tail = -1;
+    frame_track->policy = policy;
+    frame_track->referenced = NULL;
+    frame_track->use_count = NULL;
+    frame_track->last_ref = NULL;
+    frame_track->heap = NULL;
+    frame_track->heap_pos = NULL;
+    frame_track->heap_cnt = 0;
+    frame_track->heap_free = 0;
+    frame_track->heap_key = NULL;
+    frame_track->aside = NULL;
+    frame_track->hand = 0;
+    frame_track->fifo_next = NULL;
+    frame_track->fifo_prev = NULL;
+    frame_track->fifo_head = -1;
+    frame_track->fifo_tail = -1;
+    frame_track->stats.evictions = 0;
+    frame_track->stats.refaults = 0;
+    frame_track->access = NULL;
+    frame_track->frame_page = NULL;
+    frame_track->touch_next = NULL;
+    frame_track->touch_prev = NULL;
+    if (policy != LRU) {
+        frame_track->referenced = (unsigned char*)malloc(frame_number);
+        frame_track->use_count = (int*)malloc(sizeof(int) * frame_number);
+        frame_track->last_ref = (long long*)malloc(sizeof(long long) * frame_number);
+        frame_track->fifo_next = (int*)malloc(sizeof(int) * frame_number);
+        frame_track->fifo_prev = (int*)malloc(sizeof(int) * frame_number);
+    }
+    if (policy == LFU || policy == WORKING_SET) {
+        frame_track->heap = (int*)malloc(sizeof(int) * frame_number);
+        frame_track->heap_pos = (int*)malloc(sizeof(int) * frame_number);
+        frame_track->heap_key = (long long*)malloc(sizeof(long long) * frame_number);
+        frame_track->aside = (int*)malloc(sizeof(int) * frame_number);
+        for (int i = 0; i < frame_number; i++) frame_track->heap_pos[i] = -1;
+    }
+    for (int w=0; w<frame_track->map_words; w++) {
+        // mark every frame free, leaving bits past frame_number clear
+        int bits = frame_number - w * 64;
+        frame_track->free_map[w] = bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
     }
     return frame_track;
 }
 
+/**
+ * Function to count the pages of a memory size
+ *
+ * Return: number of pages
+*/
+int page_count(Frame_track *track, int mem){
+    return ceil((double)mem / track->page_size);
+}
+
+/**
+ * Function to calculate the percentage of frames in use, rounded up
+ *
+ * Return: memory usage
+*/
+int frame_usage(Frame_track *track){
+    return (int)ceil((double)(track->frame_number - track->empty_frames) / track->frame_number * 100);
+}
+
+/**
+ * Function to mark frame i free in the bitmap
+*/
+static void mark_free(int i, Frame_track *track){
+    track->free_map[i / 64] |= 1ULL << (i % 64);
+    if (i / 64 < track->free_hint) track->free_hint = i / 64;
+}
+
+/**
+ * Function to mark the frames of a process that leaves the recency list with
+ * pages in frames in the stray bitmap, or to unmark them once it rejoins the
+ * list, counting the process either way
+*/
+static void mark_stray(Process *p, Frame_track *track, int stray){
+    for (int k = 0; k < p->no_pageInFrames; k++) {
+        int i = p->frames[k];
+        if (stray) {
+            track->stray_map[i / 64] |= 1ULL << (i % 64);
+            if (i / 64 < track->stray_hint) track->stray_hint = i / 64;
+        } else {
+            track->stray_map[i / 64] &= ~(1ULL << (i % 64));
+        }
+    }
+    track->stray_cnt += stray ? 1 : -1;
+}
+
+/**
+ * Function to unmark frame i of a process out of the recency list once its
+ * page is evicted, no longer counting the process once it has none left
+*/
+static void unmark_stray(int i, Process *p, Frame_track *track){
+    track->stray_map[i / 64] &= ~(1ULL << (i % 64));
+    if (p->no_pageInFrames == 0) track->stray_cnt--;
+}
+
+/**
+ * Function to append a frame to the touch order of the pages of a process
+*/
+static void touch_append(int i, Frame_track *track, Page_table *pt){
+    track->touch_prev[i] = pt->touch_tail;
+    track->touch_next[i] = -1;
+    if (pt->touch_tail != -1) track->touch_next[pt->touch_tail] = i;
+    else pt->touch_head = i;
+    pt->touch_tail = i;
+}
+
+/**
+ * Function to unlink a frame from the touch order of the pages of a process
+*/
+static void touch_remove(int i, Frame_track *track, Page_table *pt){
+    if (track->touch_prev[i] != -1) track->touch_next[track->touch_prev[i]] = track->touch_next[i];
+    else pt->touch_head = track->touch_next[i];
+    if (track->touch_next[i] != -1) track->touch_prev[track->touch_next[i]] = track->touch_prev[i];
+    else pt->touch_tail = track->touch_prev[i];
+}
+
+/**
+ * Function to note that a process touched the page in frame i, under LRU
+ * moving it to the end of the touch order of its pages
+*/
+void page_touched(Frame_track *track, Process *p, int i){
+    if (track->touch_next == NULL || p->pt->touch_tail == i) return;
+    touch_remove(i, track, p->pt);
+    touch_append(i, track, p->pt);
+}
+
+/**
+ * Function to clear the page table entry of the page a frame held, under demand paging
+*/
+static void unmap_frame(int i, Frame_track *track, Process *owner){
+    if (track->access == NULL || track->frame_page[i] == -1) return;
+    if (track->touch_next) touch_remove(i, track, owner->pt);
+    owner->pt->frame[track->frame_page[i]] = -1;
+    track->frame_page[i] = -1;
+}
+
+/**
+ * Function to give the process holding frame i, NULL if the frame is free
+*/
+static Process* frame_owner(int i, Frame_track *track){
+    return track->owner[i] ? track->procs->at[track->owner[i] - 1] : NULL;
+}
+
+/**
+ * Function to give the process at a slot of the recency list, NULL for -1
+*/
+static Process* lru_at(Frame_track *track, int slot){
+    return slot == -1 ? NULL : track->procs->at[slot];
+}
+
+/**
+ * Function to append a process to the most recently used end of the recency list
+*/
+static void lru_append(Process *p, Frame_track *track){
+    p->lru_prev = track->lru_tail;
+    p->lru_next = -1;
+    if (track->lru_tail != -1) track->procs->at[track->lru_tail]->lru_next = p->slot;
+    else track->lru_head = p->slot;
+    track->lru_tail = p->slot;
+}
+
+/**
+ * Function to unlink a process from the recency list
+*/
+static void lru_remove(Process *p, Frame_track *track){
+    if (p->lru_prev != -1) track->procs->at[p->lru_prev]->lru_next = p->lru_next;
+    else track->lru_head = p->lru_next;
+    if (p->lru_next != -1) track->procs->at[p->lru_next]->lru_prev = p->lru_prev;
+    else track->lru_tail = p->lru_prev;
+    p->lru_prev = -1;
+    p->lru_next = -1;
+}
+
+/**
+ * Function to append a frame to the load order list
+*/
+static void fifo_append(int i, Frame_track *track){
+    track->fifo_prev[i] = track->fifo_tail;
+    track->fifo_next[i] = -1;
+    if (track->fifo_tail != -1) track->fifo_next[track->fifo_tail] = i;
+    else track->fifo_head = i;
+    track->fifo_tail = i;
+}
+
+/**
+ * Function to unlink a frame from the load order list
+*/
+static void fifo_remove(int i, Frame_track *track){
+    if (track->fifo_prev[i] != -1) track->fifo_next[track->fifo_prev[i]] = track->fifo_next[i];
+    else track->fifo_head = track->fifo_next[i];
+    if (track->fifo_next[i] != -1) track->fifo_prev[track->fifo_next[i]] = track->fifo_prev[i];
+    else track->fifo_tail = track->fifo_prev[i];
+}
+
+/**
+ * Function to get the victim heap key of a frame: its references for LFU,
+ * its last reference for WORKING_SET
+*/
+static long long frame_key(int i, Frame_track *track){
+    return track->policy == LFU ? track->use_count[i] : track->last_ref[i];
+}
+
+/**
+ * Function to check if frame a comes before frame b in the victim heap, on the
+ * keys they were placed with, then the lower index
+*/
+static int heap_before(int a, int b, Frame_track *track){
+    if (track->heap_key[a] != track->heap_key[b]) return track->heap_key[a] < track->heap_key[b];
+    return a < b;
+}
+
+/**
+ * Function to put a frame at position k of the victim heap
+*/
+static void heap_place(int i, int k, Frame_track *track){
+    track->heap[k] = i;
+    track->heap_pos[i] = k;
+}
+
+/**
+ * Function to move a frame at position k of the victim heap down to its place
+*/
+static void heap_down(int i, int k, Frame_track *track){
+    while (1) {
+        int c = 2 * k + 1;
+        if (c >= track->heap_cnt) break;
+        if (c + 1 < track->heap_cnt && heap_before(track->heap[c + 1], track->heap[c], track)) c++;
+        if (!heap_before(track->heap[c], i, track)) break;
+        heap_place(track->heap[c], k, track);
+        k = c;
+    }
+    heap_place(i, k, track);
+}
+
+/**
+ * Function to restore the victim heap around a frame whose placed key has changed
+*/
+static void heap_fix(int i, Frame_track *track){
+    int k = track->heap_pos[i];
+    while (k > 0 && heap_before(i, track->heap[(k - 1) / 2], track)) {
+        heap_place(track->heap[(k - 1) / 2], k, track);
+        k = (k - 1) / 2;
+    }
+    heap_down(i, k, track);
+}
+
+/**
+ * Function to rebuild the victim heap from its used frames with their current keys
+*/
+static void heap_rebuild(Frame_track *track){
+    int cnt = 0;
+    for (int k = 0; k < track->heap_cnt; k++) {
+        int i = track->heap[k];
+        if (track->owner[i]) {
+            track->heap_key[i] = frame_key(i, track);
+            track->heap[cnt++] = i;
+        } else {
+            track->heap_pos[i] = -1;
+        }
+    }
+    track->heap_cnt = cnt;
+    track->heap_free = 0;
+    for (int k = cnt / 2 - 1; k >= 0; k--) heap_down(track->heap[k], k, track);
+}
+
+/**
+ * Function to place a frame in the victim heap, or to move it up if its key
+ * dropped since it was placed
+*/
+static void heap_update(int i, Frame_track *track){
+    long long key = frame_key(i, track);
+    if (track->heap_pos[i] == -1) {
+        track->heap_key[i] = key;
+        heap_place(i, track->heap_cnt++, track);
+        heap_fix(i, track);
+    } else if (key < track->heap_key[i]) {
+        track->heap_key[i] = key;
+        heap_fix(i, track);
+    }
+}
+
+/**
+ * Function to add a frame just loaded to the victim heap, where it may still
+ * be if it was freed since it was last placed
+*/
+static void heap_push(int i, Frame_track *track){
+    if (track->heap_pos[i] != -1) track->heap_free--;
+    heap_update(i, track);
+}
+
+/**
+ * Function to take a frame off the victim heap
+*/
+static void heap_remove(int i, Frame_track *track){
+    int k = track->heap_pos[i], last = track->heap[--track->heap_cnt];
+    track->heap_pos[i] = -1;
+    if (last == i) return;
+    heap_place(last, k, track);
+    heap_fix(last, track);
+}
+
+/**
+ * Function to find the frame at the top of the victim heap. Freed frames are
+ * left in the heap and dropped here once they reach the top, all at once when
+ * they make up half of it. Keys only grow as
+ * frames are referenced, so a frame is moved down once it reaches the top with
+ * an old key rather than on every reference; a placed key is never above the
+ * current one, so the top with a current key is the true minimum.
+ *
+ * Return: the frame index, or -1 if no used frame is left
+*/
+static int heap_top(Frame_track *track){
+    while (track->heap_cnt > 0) {
+        int i = track->heap[0];
+        if (!track->owner[i]) {
+            if (2 * track->heap_free >= track->heap_cnt) {
+                heap_rebuild(track);
+            } else {
+                heap_remove(i, track);
+                track->heap_free--;
+            }
+            continue;
+        }
+        long long key = frame_key(i, track);
+        if (track->heap_key[i] == key) return i;
+        track->heap_key[i] = key;
+        heap_fix(i, track);
+    }
+    return -1;
+}
+
 /**
  * Function to allocate process to free frames
  * Input: 
  * virtual = 0 if process needs to load all frames to run;
  * virtual = 1 if process needs to load 4 frames to run.
  * 
+ * Free frames are taken lowest index first from the free bitmap and merged
+ * into the ascending frame list of the process.
  * 
  * Return: -1 (if there are no enough free frames in frame list)
  * Return: number of pages of this process have been inserted to the frame (if free frames are allocated to process)
 */
 int insert(Process *p, Frame_track *track, int virtual){
-    int pages_cnt = 0; 
+    int pages = page_count(track, p->mem);
     if(virtual == 0){
         // process needs to load all frames to run
-        if (track->empty_frames < ceil((double)p->mem / PAGE_SIZE)) return -1;
+        if (track->empty_frames < pages) return -1;
     } else {
         // process needs to load 4 frames to run
         if (track->empty_frames < MIN_RUNNING_PAGE) return -1;
     }
-    
-    for(int i = 0; i < FRAME_NUMBER; i++){
-        // allocate process to free frames
-        if(track->frame_list[i] == NULL){
-            track->frame_list[i] = p;
-            track->empty_frames = track->empty_frames - 1;
-            p->no_pageInFrames++;
-            pages_cnt++;
+
+    int pages_cnt = pages < track->empty_frames ? pages : track->empty_frames;
+    int held = p->no_pageInFrames;
+    if (p->isInFrame == 0 && held > 0) mark_stray(p, track, 0);
+    if (held + pages_cnt > p->frames_cap) {
+        p->frames_cap = (held + pages_cnt) * 2;
+        p->frames = (int*)realloc(p->frames, sizeof(int) * p->frames_cap);
+    }
+
+    // take the lowest free frames, then merge them with the held frames from the back
+    int *new_frames = p->frames + held;
+    int taken = 0;
+    int w = track->free_hint;
+    while (taken < pages_cnt) {
+        STAT_ADD(frames_scanned, 1);
+        if (track->free_map[w] == 0) {
+            w++;
+            continue;
+        }
+        int i = w * 64 + __builtin_ctzll(track->free_map[w]);
+        track->free_map[w] &= track->free_map[w] - 1;
+        track->owner[i] = p->slot + 1;
+        if (track->policy != LRU) {
+            track->referenced[i] = 0;
+            track->use_count[i] = 0;
+            track->last_ref[i] = p->last_used;
+            fifo_append(i, track);
+            if (track->heap) heap_push(i, track);
+        }
+        new_frames[taken++] = i;
+    }
+    track->free_hint = w; // every word before w is full
+    if (track->access) {
+        // the new frames hold the pages the process touches next
+        if (p->pt == NULL) p->pt = new_page_table(track->access, p, pages);
+        map_frames(track, p, new_frames, pages_cnt);
+        for (int k = 0; track->touch_next && k < pages_cnt; k++) {
+            if (track->frame_page[new_frames[k]] != -1) touch_append(new_frames[k], track, p->pt);
+        }
+    }
+    if (held > 0 && p->frames[held - 1] > new_frames[0]) {
+        int *tmp = track->scratch;
+        memcpy(tmp, new_frames, sizeof(int) * pages_cnt);
+        int a = held - 1, b = pages_cnt - 1, k = held + pages_cnt - 1;
+        while (b >= 0) {
+            if (a >= 0 && p->frames[a] > tmp[b]) p->frames[k--] = p->frames[a--];
+            else p->frames[k--] = tmp[b--];
         }
-        if(pages_cnt == ceil((double)p->mem / PAGE_SIZE)) break;
     }
+
+    // pages evicted from this process earlier are loaded back first
+    int back = pages_cnt < p->pages_out ? pages_cnt : p->pages_out;
+    track->stats.refaults += back;
+    p->pages_out -= back;
+
+    track->empty_frames = track->empty_frames - pages_cnt;
+    p->no_pageInFrames = held + pages_cnt;
+    if (p->isInFrame == 0) lru_append(p, track);
     p->isInFrame = 1;
     return pages_cnt;
 }
 
+/**
+ * Function to load one page of a process that is in frames into the lowest
+ * free frame, for a page fault under demand paging
+ *
+ * Return: the frame, there must be a free one
+*/
+int load_page(Process *p, Frame_track *track, int page){
+    int w = track->free_hint;
+    while (track->free_map[w] == 0) {
+        STAT_ADD(frames_scanned, 1);
+        w++;
+    }
+    int i = w * 64 + __builtin_ctzll(track->free_map[w]);
+    track->free_map[w] &= track->free_map[w] - 1;
+    track->free_hint = w;
+    track->owner[i] = p->slot + 1;
+    if (track->policy != LRU) {
+        track->referenced[i] = 0;
+        track->use_count[i] = 0;
+        track->last_ref[i] = p->last_used;
+        fifo_append(i, track);
+        if (track->heap) heap_push(i, track);
+    }
+
+    // keep the frame list ascending
+    if (p->no_pageInFrames == p->frames_cap) {
+        p->frames_cap = p->frames_cap > 0 ? p->frames_cap * 2 : MIN_RUNNING_PAGE;
+        p->frames = (int*)realloc(p->frames, sizeof(int) * p->frames_cap);
+    }
+    int k = p->no_pageInFrames;
+    while (k > 0 && p->frames[k - 1] > i) {
+        p->frames[k] = p->frames[k - 1];
+        k--;
+    }
+    p->frames[k] = i;
+    p->no_pageInFrames++;
+    track->empty_frames--;
+
+    if (p->pages_out > 0) {
+        // a page evicted from this process earlier is loaded back
+        track->stats.refaults++;
+        p->pages_out--;
+    }
+    p->pt->frame[page] = i;
+    track->frame_page[i] = page;
+    if (track->touch_next) touch_append(i, track, p->pt);
+    return i;
+}
+
 /**
  * Function to evict page frames allcoated for LRU process.
+ * The lowest indexed frames of the process are evicted first.
  *  
  * Input: 
  * pages_cnt: number of pages need to be evicted.
  * virtual = 1 if this is used for task 4
  * virtual = 0 if this is used for other tasks
+ * 
+ * Return: number of pages evicted
 */
-void evict(Process *p, Frame_track *track, int pages_cnt, int virtual){
-    for(int i = 0; i < FRAME_NUMBER; i++){
-        if(track->frame_list[i] == p){
-            track->frame_list[i] = NULL;
-            track->empty_frames = track->empty_frames + 1;
-            p->no_pageInFrames--;
-            pages_cnt--;
-            printf("%d", i);
-            if(pages_cnt != 0) printf(",");
-            else {printf("]\n");break;}
-        }
+int evict(Process *p, Frame_track *track, int pages_cnt, int virtual){
+    int evicted = 0;
+    int stray = p->isInFrame == 0 && p->no_pageInFrames > 0;
+    while (evicted < p->no_pageInFrames) {
+        int i = p->frames[evicted++];
+        STAT_ADD(frames_scanned, 1);
+        if (stray) track->stray_map[i / 64] &= ~(1ULL << (i % 64));
+        unmap_frame(i, track, p);
+        track->owner[i] = 0;
+        mark_free(i, track);
+        if (track->policy != LRU) fifo_remove(i, track);
+        if (track->heap && track->heap_pos[i] != -1) track->heap_free++;
+        track->empty_frames = track->empty_frames + 1;
+        pages_cnt--;
+        // the list closes when enough pages or every page of the victim are evicted
+        if(pages_cnt != 0 && evicted < p->no_pageInFrames) log_frame(i);
+        else {log_last_frame(i);break;}
     }
+    p->no_pageInFrames -= evicted;
+    memmove(p->frames, p->frames + evicted, sizeof(int) * p->no_pageInFrames);
+    if (stray && p->no_pageInFrames == 0) track->stray_cnt--;
     if ((virtual == 1 && p->no_pageInFrames < MIN_RUNNING_PAGE) || virtual == 0) {
+        if (p->isInFrame == 1) {
+            lru_remove(p, track);
+            if (p->no_pageInFrames > 0) mark_stray(p, track, 1);
+        }
         p->isInFrame = 0;
     }
+    return evicted;
+}
+
+/**
+ * Function to evict pages of a process to make room for another process,
+ * counting them as evictions
+*/
+void evict_victim(Process *p, Frame_track *track, int pages_cnt, int virtual){
+    int phase = STAT_PHASE(PHASE_EVICTION);
+    int evicted = evict(p, track, pages_cnt, virtual);
+    track->stats.evictions += evicted;
+    p->pages_out += evicted;
+    STAT_PHASE(phase);
+}
+
+/**
+ * Function to evict a single frame picked by a page replacement policy
+*/
+static void release_frame(int i, Frame_track *track){
+    Process *owner = frame_owner(i, track);
+
+    // remove the frame from the ascending frame list of its owner
+    int lo = 0, hi = owner->no_pageInFrames - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (owner->frames[mid] < i) lo = mid + 1;
+        else hi = mid;
+    }
+    int k = lo;
+    memmove(owner->frames + k, owner->frames + k + 1, sizeof(int) * (owner->no_pageInFrames - k - 1));
+    owner->no_pageInFrames--;
+    if (owner->isInFrame == 0) unmark_stray(i, owner, track);
+
+    unmap_frame(i, track, owner);
+    track->owner[i] = 0;
+    mark_free(i, track);
+    fifo_remove(i, track);
+    if (track->heap && track->heap_pos[i] != -1) track->heap_free++;
+    track->empty_frames++;
+    track->stats.evictions++;
+    owner->pages_out++;
+    if (owner->no_pageInFrames < MIN_RUNNING_PAGE && owner->isInFrame == 1) {
+        lru_remove(owner, track);
+        owner->isInFrame = 0;
+        if (owner->no_pageInFrames > 0) mark_stray(owner, track, 1);
+    }
+}
+
+/**
+ * Function to check if the page in a frame may be evicted for the running
+ * process: the frame is used, and its owner is neither the running process
+ * nor running on another CPU
+*/
+static int evictable(Process *owner, Process *running){
+    return owner != NULL && owner != running && owner->cpu == -1;
+}
+
+/**
+ * Function to check if the page in frame i may be evicted for the running process
+*/
+static int frame_evictable(Frame_track *track, int i, Process *running){
+    return evictable(frame_owner(i, track), running);
+}
+
+/**
+ * Function to count the processes out of the recency list with pages in
+ * frames that may be evicted for the running process. Such processes do not
+ * run, so only the running process itself may have to be left out.
+*/
+static int stray_evictable(Frame_track *track, Process *running){
+    int self = running != NULL && running->isInFrame == 0 && running->no_pageInFrames > 0;
+    return track->stray_cnt - self;
+}
+
+/**
+ * Function to check if some page in frames may be evicted for the running
+ * process. At most one process per CPU is passed over at the head of the
+ * recency list before an evictable one, so this takes no walk over frames.
+*/
+static int any_evictable(Frame_track *track, Process *running){
+    for (Process *p = lru_at(track, track->lru_head); p; p = lru_at(track, p->lru_next)) {
+        STAT_ADD(lru_scans, 1);
+        if (evictable(p, running)) return 1;
+    }
+    return stray_evictable(track, running) > 0;
+}
+
+/**
+ * Function to find the owner of the lowest frame held by a process out of the
+ * recency list, other than the running process
+ *
+ * Return: the process, NULL if there is none
+*/
+static Process* lowest_stray(Frame_track *track, Process *running){
+    if (stray_evictable(track, running) == 0) return NULL;
+    int w = track->stray_hint;
+    while (track->stray_map[w] == 0) w++;
+    track->stray_hint = w; // every word before w is clear
+    for (; w < track->map_words; w++) {
+        for (unsigned long long bits = track->stray_map[w]; bits; bits &= bits - 1) {
+            int i = w * 64 + __builtin_ctzll(bits);
+            STAT_ADD(lru_scans, 1);
+            if (frame_evictable(track, i, running)) return frame_owner(i, track);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Function to check if frame i may be picked as a victim: with own, a frame
+ * of the running process itself, else one that may be evicted for it
+*/
+static int frame_pickable(Frame_track *track, int i, Process *running, int own){
+    return own ? frame_owner(i, track) == running : frame_evictable(track, i, running);
+}
+
+/**
+ * Function to find the first frame of the victim heap that may be picked for
+ * the running process: the least frequently used one for LFU, the least
+ * recently referenced one for WORKING_SET. Frames passed over before it are
+ * taken off the heap and put back afterwards.
+ *
+ * Return: the frame index, or -1 if there is none
+*/
+static int heap_victim(Frame_track *track, Process *running, int own){
+    int set = 0, victim = -1, i;
+    while ((i = heap_top(track)) != -1) {
+        STAT_ADD(lru_scans, 1);
+        if (frame_pickable(track, i, running, own)) {
+            victim = i;
+            break;
+        }
+        heap_remove(i, track);
+        track->aside[set++] = i;
+    }
+    while (set > 0) heap_update(track->aside[--set], track);
+    return victim;
+}
+
+/**
+ * Function to pick the next victim frame for CLOCK, SECOND_CHANCE, LFU or
+ * WORKING_SET, never picking a frame of the running process or of one running
+ * on another CPU. With own, only frames of the running process are picked.
+ * When there is none the policy state is left as it was.
+ *
+ * Return: the frame index, or -1 if there is none
+*/
+static int pick_frame(Frame_track *track, Process *running, int own){
+    // a full lap of the hand or of the heap finds nothing then
+    if (!own && !any_evictable(track, running)) return -1;
+    if (track->policy == CLOCK) {
+        // clear reference bits until the hand reaches an unreferenced frame
+        int start = track->hand;
+        for (int step = 0; step <= 2 * track->frame_number; step++) {
+            int i = track->hand;
+            STAT_ADD(lru_scans, 1);
+            track->hand = (track->hand + 1) % track->frame_number;
+            if (!frame_pickable(track, i, running, own)) continue;
+            if (track->referenced[i] == 0) return i;
+            track->referenced[i] = 0;
+        }
+        // only frames that may not be picked were passed, none of them changed
+        track->hand = start;
+    } else if (track->policy == SECOND_CHANCE) {
+        // the load order is only rotated once some frame is sure to be picked
+        int first = track->fifo_head;
+        while (first != -1 && !frame_pickable(track, first, running, own)) {
+            STAT_ADD(lru_scans, 1);
+            first = track->fifo_next[first];
+        }
+        if (first == -1) return -1;
+        // referenced frames at the front of the load order go to the back
+        for (int step = 0; step <= 2 * track->frame_number && track->fifo_head != -1; step++) {
+            int i = track->fifo_head;
+            STAT_ADD(lru_scans, 1);
+            if (frame_pickable(track, i, running, own) && track->referenced[i] == 0) return i;
+            track->referenced[i] = 0;
+            fifo_remove(i, track);
+            fifo_append(i, track);
+        }
+    } else {
+        // least frequently or least recently referenced, lowest index on ties
+        return heap_victim(track, running, own);
+    }
+    return -1;
+}
+
+/**
+ * Function to compare two frame indices for qsort
+*/
+static int compare_frames(const void *a, const void *b){
+    return *(const int*)a - *(const int*)b;
+}
+
+/**
+ * Function to evict pages with a page replacement policy other than LRU and
+ * log the evicted frames in ascending order, logging nothing if no page may
+ * be evicted.
+ * WORKING_SET first evicts every page outside the working set of its process,
+ * which may free more than pages_cnt frames.
+ *
+ * Input:
+ * running: the process the frames are needed for;
+ * pages_cnt: number of pages need to be evicted.
+ *
+ * Return: number of pages evicted, 0 if every used frame belongs to running processes
+*/
+int evict_pages(Frame_track *track, Process *running, int pages_cnt, long long time_stamp){
+    int phase = STAT_PHASE(PHASE_EVICTION);
+    int cnt = 0;
+    if (track->policy == WORKING_SET && any_evictable(track, running)) {
+        // the pages outside the working set are the oldest, at the top of the heap;
+        // the other pages of their owner were mostly referenced at the same time
+        int set = 0, i;
+        while ((i = heap_top(track)) != -1 && time_stamp - track->last_ref[i] > WORKING_SET_WINDOW) {
+            STAT_ADD(lru_scans, 1);
+            Process *owner = frame_owner(i, track);
+            if (evictable(owner, running)) {
+                // highest first, so each leaves the end of the frame list of the owner
+                for (int k = owner->no_pageInFrames - 1; k >= 0; k--) {
+                    int j = owner->frames[k];
+                    STAT_ADD(frames_scanned, 1);
+                    if (time_stamp - track->last_ref[j] <= WORKING_SET_WINDOW) continue;
+                    release_frame(j, track);
+                    track->scratch[cnt++] = j;
+                }
+            } else {
+                heap_remove(i, track);
+                track->aside[set++] = i;
+            }
+        }
+        while (set > 0) heap_update(track->aside[--set], track);
+    }
+    while (cnt < pages_cnt) {
+        int i = pick_frame(track, running, 0);
+        if (i == -1) break;
+        release_frame(i, track);
+        track->scratch[cnt++] = i;
+    }
+    STAT_PHASE(phase);
+    if (cnt == 0) return 0;
+
+    // print in ascending order
+    log_evicted(time_stamp);
+    if (out_quiet()) return cnt;
+    qsort(track->scratch, cnt, sizeof(int), compare_frames);
+    for (int a = 0; a < cnt - 1; a++) log_frame(track->scratch[a]);
+    log_last_frame(track->scratch[cnt - 1]);
+    return cnt;
+}
+
+/**
+ * Function to load a page of a process over one of its own frames, once every
+ * other used frame belongs to a process running on another CPU. The policy
+ * picks the frame among those of the process; under LRU it is the one whose
+ * page was touched longest ago. The page it held is no longer in frames.
+ *
+ * Return: the frame index
+*/
+int replace_page(Process *p, Frame_track *track, int page){
+    int i;
+    if (track->policy == LRU) {
+        i = p->pt->touch_head != -1 ? p->pt->touch_head : p->frames[0];
+    } else {
+        i = pick_frame(track, p, 1);
+        // the frame holds a page just loaded
+        track->referenced[i] = 0;
+        track->use_count[i] = 0;
+        track->last_ref[i] = p->last_used;
+        fifo_remove(i, track);
+        fifo_append(i, track);
+        if (track->heap) heap_update(i, track);
+    }
+    unmap_frame(i, track, p);
+    p->pt->frame[page] = i;
+    track->frame_page[i] = page;
+    if (track->touch_next) touch_append(i, track, p->pt);
+    track->stats.evictions++;
+    return i;
+}
+
+/**
+ * Function to print the frames of a process for a RUNNING line, closing the
+ * list once pages_rem frames have been printed
+*/
+void print_frames(Process *p, int pages_rem){
+    if (out_quiet()) return;
+    for (int k=0; k<p->no_pageInFrames; k++) {
+        pages_rem --;
+        if (pages_rem == 0) log_last_frame(p->frames[k]);
+        else log_frame(p->frames[k]);
+    }
+}
+
+/**
+ * Function to mark a process in frames as the most recently used one,
+ * called after it runs and its last_used is updated
+*/
+void touch(Process *p, Frame_track *track){
+    if (track->policy != LRU) {
+        // every page of the process is referenced while it runs
+        for (int k=0; k<p->no_pageInFrames; k++) {
+            int i = p->frames[k];
+            track->referenced[i] = 1;
+            track->use_count[i]++;
+            track->last_ref[i] = p->last_used;
+        }
+    }
+    if (p->isInFrame == 0 || track->lru_tail == p->slot) return;
+    lru_remove(p, track);
+    lru_append(p, track);
+}
+
+/*
+ * Function to find least recently used process which allocated memories in
+ * frame list, other than the running process and processes running on other
+ * CPUs. The recency list is ordered by last_used, so this is the head of the
+ * list. Processes evicted below MIN_RUNNING_PAGE leave the list but keep their
+ * remaining pages, their frames marked in the stray bitmap; once only such
+ * pages are left, the owner of the lowest of their frames is taken instead.
+ *
+ * Return: the least recently used process, NULL if every page belongs to
+ * running processes
+*/
+Process* find_LRU_proc(Frame_track *track, Process *running) {
+    Process *lowest_proc = lru_at(track, track->lru_head);
+    while (lowest_proc && !evictable(lowest_proc, running)) {
+        STAT_ADD(lru_scans, 1);
+        lowest_proc = lru_at(track, lowest_proc->lru_next);
+    }
+    if (lowest_proc == NULL) lowest_proc = lowest_stray(track, running);
+    return lowest_proc;
+}
+
+/**
+ * Function to record the owner of every frame, the recency list, the state
+ * of the page replacement policy and the page statistics in a snapshot
+*/
+void snapshot_frames(Frame_track *track, Snapshot *s){
+    Snapshot_header *h = s->header;
+    h->frame_cnt = track->frame_number;
+    s->owners = (int*)malloc(sizeof(int) * track->frame_number);
+    for (int i = 0; i < track->frame_number; i++) s->owners[i] = track->owner[i] ? frame_owner(i, track)->id : -1;
+
+    h->lru_cnt = 0;
+    for (Process *p = lru_at(track, track->lru_head); p; p = lru_at(track, p->lru_next)) h->lru_cnt++;
+    s->lru = (int*)malloc(sizeof(int) * (h->lru_cnt > 0 ? h->lru_cnt : 1));
+    h->lru_cnt = 0;
+    for (Process *p = lru_at(track, track->lru_head); p; p = lru_at(track, p->lru_next)) s->lru[h->lru_cnt++] = p->id;
+
+    if (track->policy != LRU) {
+        h->has_policy = 1;
+        s->referenced = (unsigned char*)malloc(track->frame_number);
+        s->use_count = (int*)malloc(sizeof(int) * track->frame_number);
+        s->last_ref = (long long*)malloc(sizeof(long long) * track->frame_number);
+        memcpy(s->referenced, track->referenced, track->frame_number);
+        memcpy(s->use_count, track->use_count, sizeof(int) * track->frame_number);
+        memcpy(s->last_ref, track->last_ref, sizeof(long long) * track->frame_number);
+        s->fifo = (int*)malloc(sizeof(int) * track->frame_number);
+        h->fifo_cnt = 0;
+        for (int i = track->fifo_head; i != -1; i = track->fifo_next[i]) s->fifo[h->fifo_cnt++] = i;
+        h->cursor = track->hand;
+    }
+    h->evictions = track->stats.evictions;
+    h->refaults = track->stats.refaults;
+}
+
+/**
+ * Function to rebuild a frame track fresh from initialize_frame_track from a
+ * snapshot. The frame list of each process is rebuilt in ascending order.
+ *
+ * Return: 0 for success or -1 if the snapshot has another number of frames or
+ * policy, or its lists do not agree with the frames
+*/
+int restore_frames(Frame_track *track, Snapshot *s, Process **proc_list){
+    Snapshot_header *h = s->header;
+    if (h->frame_cnt != track->frame_number || h->has_policy != (track->policy != LRU) || h->cursor < 0 ||
+        h->cursor >= track->frame_number) return -1;
+
+    for (int i = 0; i < track->frame_number; i++) {
+        if (s->owners[i] == -1) continue;
+        Process *p = proc_list[s->owners[i]];
+        if (p->no_pageInFrames == p->frames_cap) {
+            p->frames_cap = p->frames_cap > 0 ? p->frames_cap * 2 : MIN_RUNNING_PAGE;
+            p->frames = (int*)realloc(p->frames, sizeof(int) * p->frames_cap);
+        }
+        p->frames[p->no_pageInFrames++] = i;
+        track->owner[i] = p->slot + 1;
+        track->free_map[i / 64] &= ~(1ULL << (i % 64));
+        track->empty_frames--;
+    }
+    // the recency list holds exactly the processes in frames
+    int in_frames = 0;
+    for (int i = 0; i < h->p_cnt; i++) in_frames += proc_list[i]->isInFrame;
+    if (in_frames != h->lru_cnt) return -1;
+    for (int k = 0; k < h->lru_cnt; k++) {
+        Process *p = proc_list[s->lru[k]];
+        if (p->isInFrame != 1 || p->lru_prev != -1 || track->lru_head == p->slot) return -1;
+        lru_append(p, track);
+    }
+    for (int i = 0; i < h->p_cnt; i++) {
+        Process *p = proc_list[i];
+        if (p->isInFrame == 0 && p->no_pageInFrames > 0) mark_stray(p, track, 1);
+    }
+
+    if (h->has_policy) {
+        memcpy(track->referenced, s->referenced, track->frame_number);
+        memcpy(track->use_count, s->use_count, sizeof(int) * track->frame_number);
+        memcpy(track->last_ref, s->last_ref, sizeof(long long) * track->frame_number);
+        // the load order holds every used frame once
+        if (h->fifo_cnt != track->frame_number - track->empty_frames) return -1;
+        for (int i = 0; i < track->frame_number; i++) track->fifo_prev[i] = -2;
+        for (int k = 0; k < h->fifo_cnt; k++) {
+            int i = s->fifo[k];
+            if (track->owner[i] == 0 || track->fifo_prev[i] != -2) return -1;
+            fifo_append(i, track);
+        }
+        track->hand = h->cursor;
+        if (track->heap) {
+            track->heap_cnt = 0;
+            track->heap_free = 0;
+            for (int i = 0; i < track->frame_number; i++) track->heap_pos[i] = -1;
+            for (int i = 0; i < track->frame_number; i++) if (track->owner[i]) heap_update(i, track);
+        }
+    }
+    track->stats.evictions = h->evictions;
+    track->stats.refaults = h->refaults;
+    return 0;
 }
 
 /**
  * Function to free frame list
 */
 void free_frame(Frame_track *track){
+    free(track->owner);
+    free(track->free_map);
+    free(track->stray_map);
+    free(track->scratch);
+    free(track->referenced);
+    free(track->use_count);
+    free(track->last_ref);
+    free(track->heap);
+    free(track->heap_pos);
+    free(track->heap_key);
+    free(track->aside);
+    free(track->fifo_next);
+    free(track->fifo_prev);
+    free(track->frame_page);
+    free(track->touch_next);
+    free(track->touch_prev);
     free(track);
 }
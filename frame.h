@@ -5,21 +5,96 @@
 #include <stdlib.h>
 #include <math.h>
 #include "process_q.h"
+#include "stats.h"
+#include "output.h"
+#include "snapshot.h"
 
-#define FRAME_NUMBER 512 // maximum frame number
-#define PAGE_SIZE 4 // fixed page and frame size
+#define FRAME_NUMBER 512 // default frame number
+#define PAGE_SIZE 4 // default page and frame size
 #define MIN_RUNNING_PAGE 4  // the minimum pages in frames that a process allowed to run
+#define WORKING_SET_WINDOW 10 // time a page stays in the working set after it was last referenced
+
+// page replacement policies for virtual memory
+#define LRU 0 // evict pages of the least recently used process
+#define CLOCK 1 // sweep frames in index order, evicting the first unreferenced one
+#define SECOND_CHANCE 2 // sweep frames in load order, evicting the first unreferenced one
+#define LFU 3 // evict the least frequently referenced frame
+#define WORKING_SET 4 // evict every page outside the working set, then the least recently referenced
+
+typedef struct Access_model Access_model;
+
+typedef struct Page_stats{
+    int evictions; // pages evicted to make room for another process
+    int refaults; // evicted pages that were loaded into frames again
+} Page_stats;
 
 typedef struct Frame_track{
-    Process* frame_list[FRAME_NUMBER]; // a frame list to store frames for process
+    int frame_number; // number of frames
+    int page_size; // page and frame size
+    int map_words; // number of 64-bit words in the free frame bitmap
+    int free_hint; // no free frame lies in a bitmap word before this one
+    unsigned int *owner; // slot + 1 of the process holding each frame in procs, 0 if the frame is free
+    Process_table *procs; // the processes owner refers to
+    unsigned long long *free_map; // bit i is set if frame i is free
+    unsigned long long *stray_map; // bit i is set if frame i belongs to a process that left the recency list
+    int stray_hint; // no bit of stray_map is set in a word before this one
+    int stray_cnt; // number of processes that left the recency list with pages in frames
+    int *scratch; // space to merge newly inserted frames into a frame list
     int empty_frames; // number of empty frames in frame list
+    int lru_head; // slot of the least recently used process in frames, -1 if none
+    int lru_tail; // slot of the most recently used process in frames, -1 if none
+    int policy; // page replacement policy
+    // per-frame state of the other policies, NULL for LRU
+    unsigned char *referenced; // reference bit of each frame, for CLOCK and SECOND_CHANCE
+    int *use_count; // times each frame has been referenced since it was loaded, for LFU
+    long long *last_ref; // time each frame was last referenced, for WORKING_SET
+    int *heap; // used frames in a min-heap on use_count for LFU or last_ref for WORKING_SET, lowest index on ties, NULL otherwise
+    int *heap_pos; // position of each used frame in heap
+    int heap_cnt; // number of frames in heap
+    int heap_free; // frames in heap freed since they were placed, dropped lazily
+    long long *heap_key; // key of each frame when it was last placed in heap, refreshed once it reaches the top
+    int *aside; // frames of running processes taken off heap while a victim is picked
+    int hand; // frame the CLOCK hand points at
+    int *fifo_next; // frames in load order, for SECOND_CHANCE
+    int *fifo_prev;
+    int fifo_head; // the frame loaded earliest, -1 if none
+    int fifo_tail; // the frame loaded latest, -1 if none
+    Page_stats stats; // eviction and refault counts
+    Access_model *access; // pages running processes touch, NULL unless pages are modelled
+    int *frame_page; // page each frame holds, -1 if none, only with access
+    int *touch_next; // frame of the same process whose page was touched after the page of this one, -1 if none, only with access under LRU
+    int *touch_prev; // frame of the same process whose page was touched before, -1 if none
 } Frame_track;
 
-Frame_track* initialize_frame_track();
+Frame_track* initialize_frame_track(int frame_number, int page_size, int policy, Process_table *procs);
+
+int page_count(Frame_track *track, int mem);
+
+int frame_usage(Frame_track *track);
 
 int insert(Process *p, Frame_track *track, int virtual);
 
-void evict(Process *p, Frame_track *track, int pages_cnt, int virtual);
+int load_page(Process *p, Frame_track *track, int page);
+
+int evict(Process *p, Frame_track *track, int pages_cnt, int virtual);
+
+void evict_victim(Process *p, Frame_track *track, int pages_cnt, int virtual);
+
+int evict_pages(Frame_track *track, Process *running, int pages_cnt, long long time_stamp);
+
+int replace_page(Process *p, Frame_track *track, int page);
+
+void page_touched(Frame_track *track, Process *p, int i);
+
+void print_frames(Process *p, int pages_rem);
+
+void touch(Process *p, Frame_track *track);
+
+Process* find_LRU_proc(Frame_track *track, Process *running);
+
+void snapshot_frames(Frame_track *track, Snapshot *s);
+
+int restore_frames(Frame_track *track, Snapshot *s, Process **proc_list);
 
 void free_frame(Frame_track *track);
 
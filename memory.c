@@ -1,128 +1,288 @@
 #include "memory.h"
 
 /**
- * Function to create and initialise blocks
+ * Function to create and initialise blocks, taking them from the block pool
+ * of the memory and growing the pool by a chunk when it is empty
  * 
  * return: Block*
 */
-Block* create_block(int start, int size, Process* p){
-    Block *b = (Block*)malloc(sizeof(Block));
+Block* create_block(Memory *m, int start, int size, Process* p){
+    if(m->spare == NULL){
+        Block_chunk *chunk = (Block_chunk*)malloc(sizeof(Block_chunk));
+        chunk->next = m->chunks;
+        m->chunks = chunk;
+        for(int i = 0; i < BLOCK_CHUNK; i++) release_block(m, &chunk->blocks[i]);
+    }
+    Block *b = m->spare;
+    m->spare = b->next;
     b->start = start;
     b->size = size;
     b->p = p;
     b->next = NULL;
     b->prev = NULL;
+    b->left = NULL;
+    b->right = NULL;
     return b;
 }
 
 /**
- * Function to initialize memory 
+ * Function to return a block to the block pool of the memory
+*/
+void release_block(Memory *m, Block *b){
+    b->next = m->spare;
+    m->spare = b;
+}
+
+/**
+ * Function to give a hole a fixed pseudo-random treap priority derived from its start
+*/
+static unsigned int hole_priority(Block *b){
+    unsigned int x = (unsigned int)b->start * 2654435761u;
+    x ^= x >> 16;
+    return x * 2246822519u;
+}
+
+/**
+ * Function to check if hole a is ordered before hole b, by size and then by start
+*/
+static int hole_before(Block *a, Block *b){
+    return a->size < b->size || (a->size == b->size && a->start < b->start);
+}
+
+/**
+ * Function to insert a hole into the treap ordered by size
+ *
+ * return: the new root
+*/
+static Block* treap_insert(Block *root, Block *b){
+    if(root == NULL){
+        b->left = NULL;
+        b->right = NULL;
+        return b;
+    }
+    if(hole_before(b, root)){
+        root->left = treap_insert(root->left, b);
+        if(hole_priority(root->left) > hole_priority(root)){
+            // rotate right
+            Block *l = root->left;
+            root->left = l->right;
+            l->right = root;
+            return l;
+        }
+    }else{
+        root->right = treap_insert(root->right, b);
+        if(hole_priority(root->right) > hole_priority(root)){
+            // rotate left
+            Block *r = root->right;
+            root->right = r->left;
+            r->left = root;
+            return r;
+        }
+    }
+    return root;
+}
+
+/**
+ * Function to join two treaps where every hole in a is ordered before every hole in b
+ *
+ * return: the new root
+*/
+static Block* treap_join(Block *a, Block *b){
+    if(a == NULL) return b;
+    if(b == NULL) return a;
+    if(hole_priority(a) > hole_priority(b)){
+        a->right = treap_join(a->right, b);
+        return a;
+    }
+    b->left = treap_join(a, b->left);
+    return b;
+}
+
+/**
+ * Function to remove a hole from the treap ordered by size
+ *
+ * return: the new root
+*/
+static Block* treap_remove(Block *root, Block *b){
+    if(root == b) return treap_join(b->left, b->right);
+    if(hole_before(b, root)) root->left = treap_remove(root->left, b);
+    else root->right = treap_remove(root->right, b);
+    return root;
+}
+
+/**
+ * Function to set the hole size recorded at an address in the segment tree
+*/
+static void tree_set(Memory *m, int addr, int size){
+    int node = m->leaves + addr;
+    m->hole_tree[node] = size;
+    for(node /= 2; node >= 1; node /= 2){
+        int l = m->hole_tree[2 * node], r = m->hole_tree[2 * node + 1];
+        m->hole_tree[node] = l > r ? l : r;
+    }
+}
+
+/**
+ * Function to find the lowest address at or after from where a hole of at least need starts
+ *
+ * return: the address, or -1 if there is no such hole
+*/
+static int tree_find(Memory *m, int node, int lo, int hi, int from, int need){
+    STAT_ADD(blocks_scanned, 1);
+    if(hi <= from || m->hole_tree[node] < need) return -1;
+    if(hi - lo == 1) return lo;
+    int mid = (lo + hi) / 2;
+    int addr = tree_find(m, 2 * node, lo, mid, from, need);
+    if(addr != -1) return addr;
+    return tree_find(m, 2 * node + 1, mid, hi, from, need);
+}
+
+/**
+ * Function to add a hole to the free-hole index
+*/
+static void index_hole(Memory *m, Block *b){
+    m->hole_at[b->start] = b;
+    tree_set(m, b->start, b->size);
+    m->by_size = treap_insert(m->by_size, b);
+}
+
+/**
+ * Function to remove a hole from the free-hole index
+*/
+static void unindex_hole(Memory *m, Block *b){
+    m->hole_at[b->start] = NULL;
+    tree_set(m, b->start, 0);
+    m->by_size = treap_remove(m->by_size, b);
+}
+
+/**
+ * Function to initialize memory, allocated to with the given fit strategy
  * 
  * return: Memory*
 */
-Memory* initialize_memory(int size){
+Memory* initialize_memory(int size, int fit){
     Memory *m = (Memory*)malloc(sizeof(Memory));
     m->size = size;
-    m->head = create_block(0, size, NULL);
+    m->fit = fit;
+    m->spare = NULL;
+    m->chunks = NULL;
+    m->head = create_block(m, 0, size, NULL);
+    m->used = 0;
+    m->leaves = 1;
+    while(m->leaves < size) m->leaves *= 2;
+    m->hole_tree = (int*)calloc(2 * m->leaves, sizeof(int));
+    m->hole_at = (Block**)calloc(size, sizeof(Block*));
+    m->by_size = NULL;
+    m->rover = 0;
+    m->compact = 0;
+    m->stats.compactions = 0;
+    m->stats.moved = 0;
+    index_hole(m, m->head);
     return m;
 }
 
 /**
- * Function to achieve first fit allocation coresponding to Task 2
- * 
- * Input: 
+ * Function to allocate a process at the start of a hole, splitting off the rest of the hole
+*/
+static void place(Process *p, Memory *m, Block *hole){
+    unindex_hole(m, hole);
+    if(hole->size > p->mem){
+        Block *b = create_block(m, hole->start, p->mem, p);
+        b->prev = hole->prev;
+        b->next = hole;
+        if(hole->prev) hole->prev->next = b;
+        else m->head = b;
+        hole->prev = b;
+
+        hole->start += p->mem;
+        hole->size -= p->mem;
+        index_hole(m, hole);
+        p->addr = b;
+    }else{
+        hole->p = p;
+        p->addr = hole;
+    }
+    m->used += p->mem;
+}
+
+/**
+ * Function to allocate a process to contiguous memory with one of the fit strategies
+ *
+ * Input:
  * process;
  * memory;
- * 
+ * fit: FIRST_FIT, BEST_FIT, NEXT_FIT or WORST_FIT.
+ *
  * return: 0 for success or -1 for failure
 */
-int first_fit_allocate(Process *p, Memory *m){
-    Block *curr = m->head;
-    while(curr){
-        if(p->mem <= curr->size && curr->p == NULL) break;
-        curr = curr->next;
-    }
-    if(curr && curr->size > p->mem){
-        Block *prev = curr->prev;
-        Block *next = curr->next;
+int fit_allocate(Process *p, Memory *m, int fit){
+    int need = p->mem > 0 ? p->mem : 1; // a hole is never empty
+    if(m->hole_tree[1] < need) return -1; // no hole is large enough
 
-        p->addr = create_block(curr->start, p->mem, p);
-        p->addr->next = create_block(curr->start + p->mem, curr->size - p->mem, NULL);
-        p->addr->next->prev = p->addr;
-
-        p->addr->prev = prev;
-        if(prev) prev->next = p->addr;
-
-        p->addr->next->next = next;
-        if(next) next->prev = p->addr->next;
+    Block *hole;
+    if(fit == BEST_FIT){
+        // smallest hole of at least the process size
+        Block *curr = m->by_size;
+        hole = NULL;
+        while(curr){
+            STAT_ADD(blocks_scanned, 1);
+            if(curr->size >= need){
+                hole = curr;
+                curr = curr->left;
+            }else{
+                curr = curr->right;
+            }
+        }
+    }else if(fit == NEXT_FIT){
+        int addr = tree_find(m, 1, 0, m->leaves, m->rover, need);
+        if(addr == -1) addr = tree_find(m, 1, 0, m->leaves, 0, need);
+        hole = m->hole_at[addr];
+    }else if(fit == WORST_FIT){
+        hole = m->hole_at[tree_find(m, 1, 0, m->leaves, 0, m->hole_tree[1])];
+    }else{
+        hole = m->hole_at[tree_find(m, 1, 0, m->leaves, 0, need)];
+    }
 
-        
-        if(curr->start == 0) m->head = p->addr;
-    }else if(curr && curr->size == p->mem){
-        curr->p = p;
-        p->addr = curr;
-    }else{return -1;}
+    place(p, m, hole);
+    m->rover = p->addr->start + p->mem;
+    if(m->rover >= m->size) m->rover = 0;
     return 0;
 }
 
 /**
- * Function to free the memory of a certain process and handle situations where the memory
- * blocks should be merged
+ * Function to free the memory of a certain process and merge the freed block
+ * with vacant neighbours in place
  * 
  * Input:
  * process;
  * memory;
 */
 void free_memory(Process *p, Memory *m){
-    p->addr->p = NULL;
-    Block *prev = p->addr->prev;
-    Block *next = p->addr->next;
-
-    if(prev && prev->p == NULL && next && next->p == NULL){
-        // if the prev and next are both vacant, merge these 3 blocks together
-        if(prev->start == 0){
-            // if the prev block is the head of the list
-            m->head = create_block(0, prev->size+p->addr->size+next->size, NULL);
-            m->head->next = next->next;
-            if(next->next) next->next->prev = m->head;
-        }else{
-            prev->prev->next = create_block(0, prev->size+p->addr->size+next->size, NULL);
-            prev->prev->next->next = next->next;
-            if(next->next) next->next->prev = prev->prev->next;
-        }
-        free(p->addr);
-    }else if(prev && prev->p == NULL){
-        // if the prev is vacant, merge it with the block just freed
-        if(prev->start == 0){
-            // if the prev block is the head of the list
-            m->head = create_block(0, prev->size+p->addr->size, NULL);
-            m->head->next = next;
-            if(next && next->next) next->next->prev = m->head;
-        }else{
-            prev->prev->next = create_block(0, prev->size+p->addr->size, NULL);
-            prev->prev->next->next = next;
-            if(next && next->next) next->next->prev = prev->prev->next;
-        }
-        free(p->addr);
-    }else if(next && next->p == NULL){
-        // if the next is vacant, merge it with the block just freed
-        if(p->addr->start == 0){
-            // if the freed block is the head of the list
-            m->head = create_block(0, p->addr->size+next->size, NULL);
-            m->head->next = next->next;
-            if(next->next) next->next->prev = m->head;
-        }else{
-            prev->next = create_block(0, p->addr->size+next->size, NULL);
-            prev->next->prev = prev;
-            prev->next->next = next->next;
-            if(next->next) next->next->prev = prev->next;
-        }
-        free(p->addr);
-    }else{
-        // both prev and next are occupied
-        p->addr->p = NULL;
+    Block *b = p->addr;
+    Block *prev = b->prev;
+    Block *next = b->next;
+    b->p = NULL;
+    m->used -= b->size;
+
+    if(prev && prev->p == NULL){
+        // if the prev is vacant, grow it over the block just freed
+        unindex_hole(m, prev);
+        prev->size += b->size;
+        prev->next = next;
+        if(next) next->prev = prev;
+        release_block(m, b);
+        b = prev;
     }
-    
+    if(next && next->p == NULL){
+        // if the next is vacant, absorb it
+        unindex_hole(m, next);
+        b->size += next->size;
+        b->next = next->next;
+        if(next->next) next->next->prev = b;
+        release_block(m, next);
+    }
+    index_hole(m, b);
+
     p->addr = NULL;
 }
 
@@ -135,24 +295,162 @@ void free_memory(Process *p, Memory *m){
  * return: memory usage
 */
 int memory_usage(Memory *m){
-    Block *curr = m->head;
-    int used = 0;
-    while(curr){
-        if(curr->p) used += curr->size;
-        curr = curr->next;
+    return ceil((double)m->used*100/m->size);
+}
+
+/**
+ * Function to calculate the fragmentation index of memory, the share of free
+ * memory outside the largest hole
+ *
+ * return: fragmentation in percent, 0 if no memory is free
+*/
+int memory_fragmentation(Memory *m){
+    int vacant = m->size - m->used;
+    if(vacant == 0) return 0;
+    return ceil((double)(vacant - m->hole_tree[1])*100/vacant);
+}
+
+/**
+ * Function to check if compacting memory would make room for a process that
+ * no hole fits: the free memory together is large enough
+*/
+int compaction_fits(Memory *m, Process *p){
+    int need = p->mem > 0 ? p->mem : 1; // a hole is never empty
+    return m->compact && m->hole_tree[1] < need && m->size - m->used >= need;
+}
+
+/**
+ * Function to find the largest process that fits in memory as it is, in the
+ * largest hole or in all free memory when compaction is enabled
+*/
+int memory_room(Memory *m){
+    return m->compact ? m->size - m->used : m->hole_tree[1];
+}
+
+/**
+ * Function to compact memory, sliding every allocated block down in address
+ * order so all free memory merges into one hole at the top
+ *
+ * return: memory moved to a new address
+*/
+long long compact_memory(Memory *m){
+    long long moved = 0;
+    int addr = 0;
+    Block *prev = NULL;
+    Block *b = m->head;
+    m->head = NULL;
+    while(b){
+        Block *next = b->next;
+        if(b->p == NULL){
+            unindex_hole(m, b);
+            release_block(m, b);
+        }else{
+            if(b->start != addr) moved += b->size;
+            b->start = addr;
+            addr += b->size;
+            b->prev = prev;
+            if(prev) prev->next = b;
+            else m->head = b;
+            prev = b;
+        }
+        b = next;
+    }
+
+    // the free memory is one hole after the last block
+    if(addr < m->size){
+        Block *hole = create_block(m, addr, m->size - addr, NULL);
+        hole->prev = prev;
+        if(prev) prev->next = hole;
+        else m->head = hole;
+        index_hole(m, hole);
+    }else if(prev){
+        prev->next = NULL;
     }
-    return ceil((double)used*100/m->size);
+    m->rover = addr < m->size ? addr : 0;
+    m->stats.compactions++;
+    m->stats.moved += moved;
+    return moved;
+}
+
+/**
+ * Function to record the blocks of memory, in address order, the next fit
+ * rover and the compaction counts in a snapshot
+*/
+void snapshot_memory(Memory *m, Snapshot *s){
+    int cnt = 0;
+    for(Block *b = m->head; b; b = b->next) cnt++;
+    s->blocks = (Snapshot_block*)malloc(sizeof(Snapshot_block) * cnt);
+    cnt = 0;
+    for(Block *b = m->head; b; b = b->next){
+        s->blocks[cnt].start = b->start;
+        s->blocks[cnt].size = b->size;
+        s->blocks[cnt].pid = b->p ? b->p->id : -1;
+        cnt++;
+    }
+    s->header->block_cnt = cnt;
+    s->header->cursor = m->rover;
+    s->header->compactions = m->stats.compactions;
+    s->header->moved = m->stats.moved;
+}
+
+/**
+ * Function to rebuild memory fresh from initialize_memory with the blocks
+ * of a snapshot, allocating them to their processes again
+ *
+ * return: 0 for success or -1 if the blocks do not cover the memory or do not
+ * fit their processes
+*/
+int restore_memory(Memory *m, Snapshot *s, Process **proc_list){
+    int end = 0;
+    for(int i = 0; i < s->header->block_cnt; i++){
+        // holes are never empty, blocks of processes with no memory are
+        if(s->blocks[i].start != end || s->blocks[i].size < (s->blocks[i].pid == -1 ? 1 : 0)) return -1;
+        end += s->blocks[i].size;
+    }
+    if(end != m->size || s->header->cursor < 0 || s->header->cursor >= m->size) return -1;
+
+    // replace the single hole of fresh memory
+    unindex_hole(m, m->head);
+    release_block(m, m->head);
+    m->head = NULL;
+    Block *prev = NULL;
+    for(int i = 0; i < s->header->block_cnt; i++){
+        Snapshot_block *r = &s->blocks[i];
+        Process *p = r->pid == -1 ? NULL : proc_list[r->pid];
+        Block *b = create_block(m, r->start, r->size, p);
+        b->prev = prev;
+        if(prev) prev->next = b;
+        else m->head = b;
+        prev = b;
+        if(p){
+            if(p->addr != NULL || p->mem != b->size) return -1;
+            p->addr = b;
+            m->used += b->size;
+        }else{
+            index_hole(m, b);
+        }
+    }
+    m->rover = s->header->cursor;
+    m->stats.compactions = s->header->compactions;
+    m->stats.moved = s->header->moved;
+    // running processes always have their memory
+    for(int c = 0; c < s->header->cpus; c++){
+        if(s->running[c] != -1 && proc_list[s->running[c]]->addr == NULL) return -1;
+    }
+    return 0;
 }
 
 /**
  * Function to free all memory allocation
 */
 void free_all_memory(Memory *m){
-    Block *curr = m->head;
+    Block_chunk *curr = m->chunks;
     while(curr){
-        Block *temp = curr;
+        Block_chunk *temp = curr;
         curr = curr->next;
         free(temp);
     }
+    free(m->hole_tree);
+    free(m->hole_at);
     free(m);
-}
\ No newline at end of file
+}
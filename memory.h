@@ -5,8 +5,17 @@
 #include <stdlib.h>
 #include <math.h>
 #include "process_q.h"
+#include "stats.h"
+#include "snapshot.h"
 
 #define MEMORY_SIZE 2048
+#define BLOCK_CHUNK 256 // number of blocks the block pool grows by
+
+// strategies to pick a hole for a process in contiguous memory
+#define FIRST_FIT 0 // lowest addressed hole that fits
+#define BEST_FIT 1 // smallest hole that fits, lowest address on ties
+#define NEXT_FIT 2 // first hole that fits at or after the last allocation, wrapping around
+#define WORST_FIT 3 // largest hole, lowest address on ties
 
 typedef struct Process Process;
 
@@ -16,23 +25,60 @@ typedef struct Block{
     Process *p; // the process allocated at this block, otherwise NULL
     Block *next; // the block after this block
     Block *prev; // the block before this block
+    Block *left; // holes ordered before this hole by size and start, if this block is a hole
+    Block *right; // holes ordered after this hole by size and start, if this block is a hole
 } Block;
 
+typedef struct Block_chunk{
+    struct Block_chunk *next; // the chunk allocated before this one
+    Block blocks[BLOCK_CHUNK];
+} Block_chunk;
+
+typedef struct Compact_stats{
+    int compactions; // times memory was compacted
+    long long moved; // memory moved to a new address by compactions
+} Compact_stats;
+
 typedef struct Memory{
     int size;
+    int fit; // FIRST_FIT, BEST_FIT, NEXT_FIT or WORST_FIT
     Block *head;
+    int used; // total size of blocks allocated to processes
+    int leaves; // number of leaves in hole_tree, a power of two no less than size
+    int *hole_tree; // max segment tree over addresses, a leaf holds the size of the hole starting there
+    Block **hole_at; // the hole starting at each address, NULL if no hole starts there
+    Block *by_size; // root of a treap of holes ordered by size, then by start
+    int rover; // address the next fit search resumes from
+    Block *spare; // pool of unused blocks, linked through next
+    Block_chunk *chunks; // every chunk the block pool has allocated
+    int compact; // 1 to compact memory when no hole fits a process but the free memory does
+    Compact_stats stats; // compaction counts
 } Memory;
 
-Block* create_block(int start, int size, Process* p);
+Block* create_block(Memory *m, int start, int size, Process* p);
 
-Memory* initialize_memory(int size);
+void release_block(Memory *m, Block *b);
+
+Memory* initialize_memory(int size, int fit);
 
 void free_memory(Process *p, Memory *m);
 
-int first_fit_allocate(Process *p, Memory *m);
+int fit_allocate(Process *p, Memory *m, int fit);
 
 int memory_usage(Memory *m);
 
+int memory_fragmentation(Memory *m);
+
+int compaction_fits(Memory *m, Process *p);
+
+int memory_room(Memory *m);
+
+long long compact_memory(Memory *m);
+
+void snapshot_memory(Memory *m, Snapshot *s);
+
+int restore_memory(Memory *m, Snapshot *s, Process **proc_list);
+
 void free_all_memory(Memory *m);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,442 @@
+#include "output.h"
+
+static __thread Writer out; // the event log writer, one per thread so sweep runs log separately
+
+/**
+ * Function to start the event log
+ *
+ * Input:
+ * mode: OUT_TEXT, OUT_QUIET, or OUT_BINARY once out_open_trace has
+ * opened the trace file;
+ * cpus: number of CPUs the processes run on.
+*/
+void out_init(int mode, int cpus){
+    out.len = 0;
+    out.cpus = cpus;
+    out.mode = mode;
+    out.file = stdout;
+    out.has_pending = 0;
+    out.events = 0;
+}
+
+/**
+ * Function to open a binary trace and write its header and process table.
+ * Events are recorded to it from then on.
+ *
+ * Return: 0 for success or -1 if the file cannot be opened
+*/
+int out_open_trace(char *path, Process **proc_list, int p_cnt, int cpus){
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) return -1;
+    out_init(OUT_BINARY, cpus);
+    out.file = f;
+
+    Trace_header header;
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.record_size = sizeof(Event_record);
+    header.p_cnt = p_cnt;
+    header.cpus = cpus;
+    fwrite(&header, sizeof(header), 1, f);
+    for (int i = 0; i < p_cnt; i++) {
+        Trace_process entry;
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.pname, proc_list[i]->pname, MAX_NAME_LENGTH);
+        entry.arr_time = proc_list[i]->arr_time;
+        entry.serv_time = proc_list[i]->serv_time;
+        fwrite(&entry, sizeof(entry), 1, f);
+    }
+    return 0;
+}
+
+/**
+ * Function to check if the event log is skipped, so callers can avoid
+ * preparing output nobody will see
+*/
+int out_quiet(){
+    return out.mode == OUT_QUIET;
+}
+
+/**
+ * Function to get the number of events logged since out_init, whatever the mode
+*/
+long long out_events(){
+    return out.events;
+}
+
+/**
+ * Function to write all pending output
+*/
+void out_flush(){
+    if (out.len > 0) fwrite(out.buf, 1, out.len, out.file);
+    out.len = 0;
+}
+
+/**
+ * Function to append a string to the text event log
+*/
+void out_str(const char *s){
+    if (out.mode != OUT_TEXT) return;
+    int n = strlen(s);
+    if (out.len + n > OUT_BUFFER) out_flush();
+    memcpy(out.buf + out.len, s, n);
+    out.len += n;
+}
+
+/**
+ * Function to append a character to the text event log
+*/
+void out_char(char c){
+    if (out.mode != OUT_TEXT) return;
+    if (out.len == OUT_BUFFER) out_flush();
+    out.buf[out.len++] = c;
+}
+
+/**
+ * Function to append an integer in decimal to the text event log
+*/
+void out_int(long long v){
+    if (out.mode != OUT_TEXT) return;
+    char digits[24];
+    int n = 0;
+    unsigned long long u = v < 0 ? -(unsigned long long)v : (unsigned long long)v;
+    do {
+        digits[n++] = '0' + u % 10;
+        u /= 10;
+    } while (u > 0);
+    if (v < 0) digits[n++] = '-';
+
+    if (out.len + n > OUT_BUFFER) out_flush();
+    while (n > 0) out.buf[out.len++] = digits[--n];
+}
+
+/**
+ * Function to append the pending record to the binary trace
+*/
+static void emit_pending(){
+    if (!out.has_pending) return;
+    if (out.len + (int)sizeof(Event_record) > OUT_BUFFER) out_flush();
+    memcpy(out.buf + out.len, &out.pending, sizeof(Event_record));
+    out.len += sizeof(Event_record);
+    out.has_pending = 0;
+}
+
+/**
+ * Function to start a binary record, appending the one before it
+*/
+static Event_record* new_record(int type, long long time_stamp, Process *p){
+    emit_pending();
+    Event_record *r = &out.pending;
+    memset(r, 0, sizeof(Event_record));
+    r->type = type;
+    r->time = time_stamp;
+    r->pid = p ? p->id : -1;
+    r->first = -1;
+    r->last = -1;
+    if (p && p->cpu != -1) r->flags = p->cpu << CPU_SHIFT;
+    out.has_pending = 1;
+    return r;
+}
+
+/**
+ * Function to flush the event log and close the binary trace, if any
+*/
+void out_close(){
+    emit_pending();
+    out_flush();
+    if (out.mode == OUT_BINARY) fclose(out.file);
+    out.file = stdout;
+}
+
+/**
+ * Function to write the CPU a process runs on, when there are more than one
+*/
+static void cpu_field(Process *p){
+    if (out.cpus == 1) return;
+    out_str(",cpu=");
+    out_int(p->cpu);
+}
+
+/**
+ * Function to write the start of a RUNNING line, up to the remaining time
+*/
+static void running_prefix(long long time_stamp, Process *p){
+    out_int(time_stamp);
+    out_str(",RUNNING,process-name=");
+    out_str(p->pname);
+    cpu_field(p);
+    out_str(",remaining-time=");
+    out_int(p->rem_time);
+}
+
+/**
+ * Function to log a process starting to run, corresponding to task 1
+*/
+void log_running(long long time_stamp, Process *p){
+    out.events++;
+    if (out.mode == OUT_BINARY) {
+        Event_record *r = new_record(EV_RUNNING, time_stamp, p);
+        r->value = p->rem_time;
+        r->style = RUN_PLAIN;
+        return;
+    }
+    running_prefix(time_stamp, p);
+    out_char('\n');
+}
+
+/**
+ * Function to log a process starting to run in contiguous memory at address at
+*/
+void log_running_at(long long time_stamp, Process *p, int usage, int at){
+    out.events++;
+    if (out.mode == OUT_BINARY) {
+        Event_record *r = new_record(EV_RUNNING, time_stamp, p);
+        r->value = p->rem_time;
+        r->style = RUN_AT;
+        r->usage = usage;
+        r->first = at;
+        return;
+    }
+    running_prefix(time_stamp, p);
+    out_str(",mem-usage=");
+    out_int(usage);
+    out_str("%,allocated-at=");
+    out_int(at);
+    out_char('\n');
+}
+
+/**
+ * Function to log a process starting to run in frames, opening its frame list
+*/
+void log_running_frames(long long time_stamp, Process *p, int usage){
+    out.events++;
+    if (out.mode == OUT_BINARY) {
+        Event_record *r = new_record(EV_RUNNING, time_stamp, p);
+        r->value = p->rem_time;
+        r->style = RUN_FRAMES;
+        r->usage = usage;
+        return;
+    }
+    running_prefix(time_stamp, p);
+    out_str(",mem-usage=");
+    out_int(usage);
+    out_str("%,mem-frames=[");
+}
+
+/**
+ * Function to log a process finishing
+*/
+void log_finished(long long time_stamp, Process *p, int proc_remaining){
+    out.events++;
+    if (out.mode == OUT_BINARY) {
+        Event_record *r = new_record(EV_FINISHED, time_stamp, p);
+        r->value = proc_remaining;
+        return;
+    }
+    out_int(time_stamp);
+    out_str(",FINISHED,process-name=");
+    out_str(p->pname);
+    cpu_field(p);
+    out_str(",proc-remaining=");
+    out_int(proc_remaining);
+    out_char('\n');
+}
+
+/**
+ * Function to log the start of an eviction, opening the list of evicted frames
+*/
+void log_evicted(long long time_stamp){
+    out.events++;
+    if (out.mode == OUT_BINARY) {
+        new_record(EV_EVICTED, time_stamp, NULL);
+        return;
+    }
+    out_int(time_stamp);
+    out_str(",EVICTED,evicted-frames=[");
+}
+
+/**
+ * Function to add a frame to the open frame list of the binary trace,
+ * growing the last range or starting a new one
+*/
+static void record_frame(int frame){
+    Event_record *r = &out.pending;
+    if (r->type != EV_FRAMES) {
+        // the record opening the list holds its first range
+        if (r->first == -1) {
+            r->first = frame;
+            r->last = frame;
+            return;
+        }
+        if (frame == r->last + 1) {
+            r->last = frame;
+            return;
+        }
+    } else {
+        int *range = r->ranges[r->style - 1];
+        if (frame == range[1] + 1) {
+            range[1] = frame;
+            return;
+        }
+        if (r->style < FRAME_RANGES) {
+            r->ranges[r->style][0] = frame;
+            r->ranges[r->style][1] = frame;
+            r->style++;
+            return;
+        }
+    }
+    r = new_record(EV_FRAMES, 0, NULL);
+    r->style = 1;
+    r->ranges[0][0] = frame;
+    r->ranges[0][1] = frame;
+}
+
+/**
+ * Function to log a frame of the open frame list, with more to follow
+*/
+void log_frame(int frame){
+    if (out.mode == OUT_BINARY) {
+        record_frame(frame);
+        return;
+    }
+    out_int(frame);
+    out_char(',');
+}
+
+/**
+ * Function to log the last frame of the open frame list, closing it
+*/
+void log_last_frame(int frame){
+    if (out.mode == OUT_BINARY) {
+        record_frame(frame);
+        log_frames_end();
+        return;
+    }
+    out_int(frame);
+    out_str("]\n");
+}
+
+/**
+ * Function to close the open frame list
+*/
+void log_frames_end(){
+    if (out.mode == OUT_BINARY) {
+        out.pending.flags |= FRAMES_CLOSED;
+        emit_pending();
+        return;
+    }
+    out_str("]\n");
+}
+
+/**
+ * Function to record the eviction and refault counts in the binary trace, so
+ * the converter can print the page replacement report
+*/
+void log_page_stats(int evictions, int refaults){
+    if (out.mode != OUT_BINARY) return;
+    Event_record *r = new_record(EV_PAGE_STATS, 0, NULL);
+    r->value = evictions;
+    r->first = refaults;
+}
+
+/**
+ * Function to log contiguous memory being compacted, with the memory moved
+ * and the fragmentation index before it in percent
+*/
+void log_compacted(long long time_stamp, long long moved, int fragmentation){
+    out.events++;
+    if (out.mode == OUT_BINARY) {
+        Event_record *r = new_record(EV_COMPACTED, time_stamp, NULL);
+        r->value = moved;
+        r->usage = fragmentation;
+        return;
+    }
+    out_int(time_stamp);
+    out_str(",COMPACTED,moved=");
+    out_int(moved);
+    out_str(",fragmentation=");
+    out_int(fragmentation);
+    out_str("%\n");
+}
+
+/**
+ * Function to record the compaction counts in the binary trace, so the
+ * converter can print the compaction report
+*/
+void log_compact_stats(int compactions, long long moved){
+    if (out.mode != OUT_BINARY) return;
+    Event_record *r = new_record(EV_COMPACT_STATS, 0, NULL);
+    r->value = moved;
+    r->first = compactions;
+}
+
+/**
+ * Function to add a finished process to running performance totals
+*/
+void add_performance(Perf_totals *totals, Process *p){
+    totals->turnaround += p->complete_time - p->arr_time;
+    double over = ((double)(p->complete_time - p->arr_time))/(double)p->serv_time;
+    totals->over += over;
+    if(over > totals->max_over) totals->max_over = over;
+    totals->cnt++;
+}
+
+/**
+ * Function to calculate turnaround time, time overhead and makespan from
+ * performance totals.
+ *
+ * Input: totals of the finished processes;
+ * time_complete is the time stamp when all processses are finished;
+ * perf to hold the results.
+*/
+void total_performance(Perf_totals *totals, long long time_complete, Performance *perf){
+    perf->turnaround = ceil((double)totals->turnaround/(double)totals->cnt);
+    perf->max_over = totals->max_over;
+    perf->avg_over = ((int)(totals->over/totals->cnt * 100 + 0.5)) / 100.0;
+    perf->makespan = time_complete;
+}
+
+/**
+ * Function to calculate turnaround time, time overhead and makespan.
+ *
+ * Input: process list which contains all processes;
+ * cnt to count the number of processses;
+ * time_complete is the time stamp when all processses are finished;
+ * perf to hold the results.
+*/
+void measure_performance(Process **proc_list, int cnt, long long time_complete, Performance *perf){
+    Perf_totals totals = {0, 0, 0, 0};
+    for(int i = 0; i < cnt; i++) add_performance(&totals, proc_list[i]);
+    total_performance(&totals, time_complete, perf);
+}
+
+/**
+ * Function to print turnaround time, time overhead and makespan
+*/
+static void show_performance(Performance *perf){
+    printf("Turnaround time %.f\n", perf->turnaround);
+    printf("Time overhead %.2f %.2f\n", perf->max_over, perf->avg_over);
+    printf("Makespan %lld\n", perf->makespan);
+}
+
+/**
+ * Function to calculate and print turnaround time, time overhead and makespan.
+ *
+ * Input: process list which contains all processes;
+ * cnt to count the number of processses;
+ * time_complete is the time stamp when all processses are finished.
+*/
+void print_performance(Process **proc_list, int cnt, long long time_complete){
+    Performance perf;
+    measure_performance(proc_list, cnt, time_complete, &perf);
+    show_performance(&perf);
+}
+
+/**
+ * Function to print turnaround time, time overhead and makespan from the
+ * totals of processes released as they finished
+*/
+void print_totals(Perf_totals *totals, long long time_complete){
+    Performance perf;
+    total_performance(totals, time_complete, &perf);
+    show_performance(&perf);
+}
@@ -0,0 +1,142 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "process_q.h"
+
+#define OUT_BUFFER (1 << 16) // bytes of event output gathered before they are written
+
+// where the event log goes
+#define OUT_TEXT 0 // text lines on stdout
+#define OUT_QUIET 1 // nowhere, only the performance statistics are printed
+#define OUT_BINARY 2 // fixed-size records in a binary trace file
+
+#define TRACE_MAGIC "ALLOCEV2" // first bytes of a binary trace
+
+// event types of binary trace records
+#define EV_RUNNING 0 // a process starts to run
+#define EV_FINISHED 1 // a process finishes
+#define EV_EVICTED 2 // frames are evicted
+#define EV_FRAMES 3 // more ranges of the frame list opened by the records before
+#define EV_PAGE_STATS 4 // eviction and refault counts, last record when -p is given
+#define EV_COMPACTED 5 // contiguous memory is compacted
+#define EV_COMPACT_STATS 6 // compaction counts, last record when --compact is given
+
+// what a RUNNING line shows after the remaining time
+#define RUN_PLAIN 0 // nothing, task 1
+#define RUN_AT 1 // memory usage and where the process is allocated, task 2 and buddy
+#define RUN_FRAMES 2 // memory usage and a frame list, task 3 and task 4
+
+#define FRAMES_CLOSED 1 // flag of the record holding the end of a frame list
+#define CPU_SHIFT 1 // the flags above FRAMES_CLOSED hold the CPU of RUNNING and FINISHED records
+#define FRAME_RANGES 3 // frame ranges an EV_FRAMES record holds
+
+typedef struct Trace_header{
+    char magic[8]; // TRACE_MAGIC
+    int record_size; // size of an Event_record, to reject traces of another layout
+    int p_cnt; // number of Trace_process entries between the header and the records
+    int cpus; // number of CPUs of the run
+} Trace_header;
+
+typedef struct Trace_process{
+    char pname[MAX_NAME_LENGTH]; // process name, not terminated if it is 8 characters long
+    long long arr_time; // arrival time
+    long long serv_time; // service time
+} Trace_process;
+
+typedef struct Event_record{
+    unsigned char type; // EV_RUNNING, EV_FINISHED, EV_EVICTED, EV_FRAMES or EV_PAGE_STATS
+    unsigned char style; // RUN_PLAIN, RUN_AT or RUN_FRAMES for RUNNING, number of ranges for EV_FRAMES
+    unsigned char usage; // memory usage in percent, for RUN_AT and RUN_FRAMES, fragmentation for COMPACTED
+    unsigned char flags; // FRAMES_CLOSED, and the CPU shifted by CPU_SHIFT
+    int pid; // position of the process in the trace, -1 if the event has no process
+    union {
+        struct {
+            long long time; // time stamp of the event
+            long long value; // remaining time for RUNNING, processes remaining for FINISHED, evictions for PAGE_STATS, memory moved for COMPACTED and COMPACT_STATS
+            int first; // first frame of a range, where the process is allocated for RUN_AT, refaults for PAGE_STATS, compactions for COMPACT_STATS, -1 if none
+            int last; // last frame of the range
+        };
+        int ranges[FRAME_RANGES][2]; // first and last frames of each range, for EV_FRAMES
+    };
+} Event_record;
+
+typedef struct Writer{
+    char buf[OUT_BUFFER]; // pending output
+    int len; // bytes pending in buf
+    int mode; // OUT_TEXT, OUT_QUIET or OUT_BINARY
+    FILE *file; // where buf is written
+    Event_record pending; // binary record whose frame range may still grow
+    int has_pending; // 1 if pending holds a record
+    long long events; // RUNNING, FINISHED and EVICTED events logged
+    int cpus; // number of CPUs, events name the CPU when there are more than one
+} Writer;
+
+typedef struct Performance{
+    double turnaround; // average turnaround time, rounded up
+    double max_over; // maximum time overhead
+    double avg_over; // average time overhead, rounded to two decimals
+    long long makespan; // time stamp when all processes are finished
+} Performance;
+
+typedef struct Perf_totals{
+    long long turnaround; // sum of turnaround times
+    double over; // sum of time overheads
+    double max_over; // maximum time overhead
+    int cnt; // number of processes added
+} Perf_totals;
+
+void out_init(int mode, int cpus);
+
+int out_open_trace(char *path, Process **proc_list, int p_cnt, int cpus);
+
+int out_quiet();
+
+long long out_events();
+
+void out_str(const char *s);
+
+void out_char(char c);
+
+void out_int(long long v);
+
+void out_flush();
+
+void out_close();
+
+void log_running(long long time_stamp, Process *p);
+
+void log_running_at(long long time_stamp, Process *p, int usage, int at);
+
+void log_running_frames(long long time_stamp, Process *p, int usage);
+
+void log_finished(long long time_stamp, Process *p, int proc_remaining);
+
+void log_evicted(long long time_stamp);
+
+void log_frame(int frame);
+
+void log_last_frame(int frame);
+
+void log_frames_end();
+
+void log_page_stats(int evictions, int refaults);
+
+void log_compacted(long long time_stamp, long long moved, int fragmentation);
+
+void log_compact_stats(int compactions, long long moved);
+
+void add_performance(Perf_totals *totals, Process *p);
+
+void total_performance(Perf_totals *totals, long long time_complete, Performance *perf);
+
+void measure_performance(Process **proc_list, int cnt, long long time_complete, Performance *perf);
+
+void print_performance(Process **proc_list, int cnt, long long time_complete);
+
+void print_totals(Perf_totals *totals, long long time_complete);
+
+#endif
@@ -0,0 +1,307 @@
+#include "paging.h"
+
+/**
+ * Function to order access traces by process name
+*/
+static int compare_traces(const void *a, const void *b){
+    return strcmp(((const Access_trace*)a)->pname, ((const Access_trace*)b)->pname);
+}
+
+/**
+ * Function to read an access trace: one line per process, its name followed
+ * by the pages it touches in order. Blank lines are skipped.
+ *
+ * Return: exits if the file cannot be read or a line is not valid
+*/
+static void read_access_trace(Access_model *model, char *path){
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    int cap = 16;
+    model->traces = (Access_trace*)malloc(sizeof(Access_trace) * cap);
+    model->trace_cnt = 0;
+
+    char *line = NULL;
+    size_t line_cap = 0;
+    int line_no = 0;
+    while (getline(&line, &line_cap, f) != -1) {
+        line_no++;
+        char *c = line;
+        while (*c == ' ' || *c == '\t') c++;
+        if (*c == '\n' || *c == '\r' || *c == '\0') continue;
+
+        if (model->trace_cnt == cap) {
+            cap *= 2;
+            model->traces = (Access_trace*)realloc(model->traces, sizeof(Access_trace) * cap);
+        }
+        Access_trace *t = &model->traces[model->trace_cnt];
+        int len = strcspn(c, " \t\r\n");
+        if (len > MAX_NAME_LENGTH) {
+            fprintf(stderr, "Invalid access trace line %d of %s\n", line_no, path);
+            exit(EXIT_FAILURE);
+        }
+        memcpy(t->pname, c, len);
+        t->pname[len] = '\0';
+        c += len;
+
+        int pages_cap = 16;
+        t->pages = (int*)malloc(sizeof(int) * pages_cap);
+        t->cnt = 0;
+        while (1) {
+            while (*c == ' ' || *c == '\t') c++;
+            if (*c == '\n' || *c == '\r' || *c == '\0') break;
+            char *end;
+            long page = strtol(c, &end, 10);
+            if (end == c || page < 0 || page > INT_MAX || (*end != ' ' && *end != '\t' && *end != '\r' && *end != '\n' && *end != '\0')) {
+                fprintf(stderr, "Invalid access trace line %d of %s\n", line_no, path);
+                exit(EXIT_FAILURE);
+            }
+            if (t->cnt == pages_cap) {
+                pages_cap *= 2;
+                t->pages = (int*)realloc(t->pages, sizeof(int) * pages_cap);
+            }
+            t->pages[t->cnt++] = (int)page;
+            c = end;
+        }
+        if (t->cnt == 0) {
+            fprintf(stderr, "Access trace line %d of %s lists no pages\n", line_no, path);
+            exit(EXIT_FAILURE);
+        }
+        model->trace_cnt++;
+    }
+    free(line);
+    fclose(f);
+
+    qsort(model->traces, model->trace_cnt, sizeof(Access_trace), compare_traces);
+    for (int i = 1; i < model->trace_cnt; i++) {
+        if (strcmp(model->traces[i - 1].pname, model->traces[i].pname) == 0) {
+            fprintf(stderr, "%s lists the pages of %s more than once\n", path, model->traces[i].pname);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ * Function to read the access model given for -A: sequential, random,
+ * strided with an optional stride as strided:N, or trace:FILE
+ *
+ * Input:
+ * spec: the value of -A;
+ * latency: time a page fault stalls the process for.
+ *
+ * Return: the access model, NULL if spec names none
+*/
+Access_model* read_access_model(char *spec, long long latency){
+    Access_model *model = (Access_model*)malloc(sizeof(Access_model));
+    model->stride = ACCESS_STRIDE;
+    model->latency = latency;
+    model->traces = NULL;
+    model->trace_cnt = 0;
+    if (strcmp(spec, "sequential") == 0) {
+        model->kind = ACCESS_SEQUENTIAL;
+    } else if (strcmp(spec, "random") == 0) {
+        model->kind = ACCESS_RANDOM;
+    } else if (strncmp(spec, "strided", 7) == 0 && (spec[7] == '\0' || spec[7] == ':')) {
+        model->kind = ACCESS_STRIDED;
+        if (spec[7] == ':') {
+            char *end;
+            long stride = strtol(spec + 8, &end, 10);
+            if (spec[8] == '\0' || *end != '\0' || stride < 1 || stride > INT_MAX) {
+                free(model);
+                return NULL;
+            }
+            model->stride = (int)stride;
+        }
+    } else if (strncmp(spec, "trace:", 6) == 0 && spec[6] != '\0') {
+        model->kind = ACCESS_TRACE;
+        read_access_trace(model, spec + 6);
+    } else {
+        free(model);
+        return NULL;
+    }
+    return model;
+}
+
+/**
+ * Function to free an access model and its traces
+*/
+void free_access_model(Access_model *model){
+    for (int i = 0; i < model->trace_cnt; i++) free(model->traces[i].pages);
+    free(model->traces);
+    free(model);
+}
+
+/**
+ * Function to start the page table of a process when it is first loaded,
+ * with no page in frames
+ *
+ * Return: the page table, exits if the access trace of the process names a
+ * page past its last one
+*/
+Page_table* new_page_table(Access_model *model, Process *p, int pages){
+    Page_table *pt = (Page_table*)malloc(sizeof(Page_table));
+    pt->pages = pages;
+    pt->frame = (int*)malloc(sizeof(int) * (pages > 0 ? pages : 1));
+    for (int i = 0; i < pages; i++) pt->frame[i] = -1;
+    pt->cursor = 0;
+    pt->seed = ((unsigned int)p->id + 1) * 2654435761u | 1;
+    pt->trace = NULL;
+    pt->accesses = 0;
+    pt->faults = 0;
+    pt->ran = 0;
+    pt->touch_head = -1;
+    pt->touch_tail = -1;
+    if (model->kind == ACCESS_TRACE) {
+        Access_trace key;
+        strcpy(key.pname, p->pname);
+        pt->trace = (Access_trace*)bsearch(&key, model->traces, model->trace_cnt, sizeof(Access_trace), compare_traces);
+        for (int k = 0; pt->trace && k < pt->trace->cnt; k++) {
+            if (pt->trace->pages[k] >= pages) {
+                fprintf(stderr, "The access trace of %s touches page %d, it only has %d pages\n", p->pname, pt->trace->pages[k], pages);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    return pt;
+}
+
+/**
+ * Function to free a page table
+*/
+void free_page_table(Page_table *pt){
+    if (pt == NULL) return;
+    free(pt->frame);
+    free(pt);
+}
+
+/**
+ * Function to give the page a process touches next under its access model
+*/
+static int next_page(Access_model *model, Page_table *pt){
+    int page;
+    if (pt->trace) {
+        page = pt->trace->pages[pt->cursor];
+        pt->cursor = (pt->cursor + 1) % pt->trace->cnt;
+    } else if (model->kind == ACCESS_RANDOM) {
+        // xorshift32
+        pt->seed ^= pt->seed << 13;
+        pt->seed ^= pt->seed >> 17;
+        pt->seed ^= pt->seed << 5;
+        page = pt->seed % pt->pages;
+    } else {
+        page = pt->cursor;
+        int step = model->kind == ACCESS_STRIDED ? model->stride : 1;
+        pt->cursor = (int)(((long long)pt->cursor + step) % pt->pages);
+    }
+    return page;
+}
+
+/**
+ * Function to give frames just loaded for a process the pages it has not in
+ * frames, starting from the page it touches next. Frames left over once every
+ * page is in frames hold none.
+*/
+void map_frames(Frame_track *track, Process *p, int *frames, int cnt){
+    Page_table *pt = p->pt;
+    int start = pt->trace ? pt->trace->pages[pt->cursor] : pt->cursor;
+    int k = 0;
+    for (int n = 0; n < pt->pages && k < cnt; n++) {
+        int page = (start + n) % pt->pages;
+        if (pt->frame[page] != -1) continue;
+        pt->frame[page] = frames[k];
+        track->frame_page[frames[k++]] = page;
+    }
+    while (k < cnt) track->frame_page[frames[k++]] = -1;
+}
+
+/**
+ * Function to handle a page fault with no free frame by evicting a page of
+ * another process the way virtual admission does, or else by loading the page
+ * over a frame of the process itself picked by the replacement policy. No
+ * victim is looked for while the process holds every used frame. Replacing a
+ * page of its own is not logged, as no other process loses a frame.
+*/
+static void fault_page(Frame_track *track, Process *p, int page, long long time_stamp){
+    if (track->empty_frames > 0) {
+        load_page(p, track, page);
+        return;
+    }
+    int phase = STAT_PHASE(PHASE_EVICTION);
+    if (p->no_pageInFrames < track->frame_number) {
+        if (track->policy != LRU) {
+            evict_pages(track, p, 1, time_stamp);
+        } else {
+            Process *victim = find_LRU_proc(track, p);
+            if (victim) {
+                log_evicted(time_stamp);
+                evict_victim(victim, track, 1, 1);
+            }
+        }
+    }
+    if (track->empty_frames > 0) {
+        load_page(p, track, page);
+        STAT_PHASE(phase);
+        return;
+    }
+
+    // every other page belongs to running processes
+    replace_page(p, track, page);
+    STAT_PHASE(phase);
+}
+
+/**
+ * Function to run the page accesses of a process that ran for some time,
+ * one page per time unit once the stall of earlier faults is over, faulting
+ * pages that are not in frames back in. The stall left is the latency of
+ * every fault less the time the process ran without touching a page.
+ *
+ * Input:
+ * frame track with its access model;
+ * p: the process, in frames and running, its remaining time not yet charged;
+ * elapsed: time since the last call, it runs for less if it finishes first;
+ * time_stamp: when it started to run, for the evictions logged.
+ *
+ * Return: time the new faults stall the process for, the one place the
+ * stall is added to its remaining time
+*/
+long long access_pages(Frame_track *track, Process *p, long long elapsed, long long time_stamp){
+    Page_table *pt = p->pt;
+    long long faults = 0;
+    long long ran = p->rem_time < elapsed ? p->rem_time : elapsed;
+    long long stall = pt->faults * track->access->latency - (pt->ran - pt->accesses);
+    long long stalled = stall < ran ? stall : ran;
+    if (stalled < 0) stalled = 0;
+    for (long long k = stalled; k < ran && pt->pages > 0; k++) {
+        int page = next_page(track->access, pt);
+        pt->accesses++;
+        if (pt->frame[page] != -1) {
+            page_touched(track, p, pt->frame[page]);
+            continue;
+        }
+        faults++;
+        fault_page(track, p, page, time_stamp);
+    }
+    pt->faults += faults;
+    // a process that would finish before elapsed waits out its new faults first
+    long long added = faults * track->access->latency;
+    pt->ran += p->rem_time + added < elapsed ? p->rem_time + added : elapsed;
+    return added;
+}
+
+/**
+ * Function to print the page accesses and faults of each process, with the
+ * fault rate and the slowdown, its service time with the fault stalls over
+ * its service time
+*/
+void print_page_faults(Process **proc_list, int cnt, long long latency){
+    for (int i = 0; i < cnt; i++) {
+        Process *p = proc_list[i];
+        long long accesses = p->pt ? p->pt->accesses : 0;
+        long long faults = p->pt ? p->pt->faults : 0;
+        double rate = accesses > 0 ? (double)faults * 100 / accesses : 0;
+        double slowdown = p->serv_time > 0 ? (double)(p->serv_time + faults * latency) / p->serv_time : 1;
+        printf("Faults %s accesses=%lld faults=%lld rate=%.2f%% slowdown=%.2f\n", p->pname, accesses, faults, rate, slowdown);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef PAGING_H
+#define PAGING_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "process_q.h"
+#include "frame.h"
+
+// how a running process picks the pages it touches, one page per time unit it runs
+#define ACCESS_SEQUENTIAL 0 // every page in turn, starting over after the last
+#define ACCESS_RANDOM 1 // pages drawn at random, the same for every run of a trace
+#define ACCESS_STRIDED 2 // every stride-th page, wrapping around
+#define ACCESS_TRACE 3 // the pages listed for the process in an access trace, sequential if none are
+
+#define ACCESS_STRIDE 4 // stride of -A strided
+#define FAULT_LATENCY 1 // default time a page fault stalls the process for
+
+typedef struct Access_trace{
+    char pname[MAX_NAME_LENGTH + 1]; // process the pages are listed for
+    int *pages; // pages touched in order, repeated once the list is done
+    int cnt; // number of pages
+} Access_trace;
+
+/**
+ * Which pages running processes touch under demand paging, and what a page
+ * fault costs them
+*/
+struct Access_model{
+    int kind; // ACCESS_SEQUENTIAL, ACCESS_RANDOM, ACCESS_STRIDED or ACCESS_TRACE
+    int stride; // stride of ACCESS_STRIDED
+    long long latency; // time added to a process for each page fault
+    Access_trace *traces; // per-process page lists of ACCESS_TRACE, sorted by name
+    int trace_cnt; // number of processes in traces
+};
+
+/**
+ * Pages of a process under demand paging
+*/
+struct Page_table{
+    int pages; // number of pages
+    int *frame; // frame holding each page, -1 if it is not in frames
+    int cursor; // next page, or next position in the page list of an access trace
+    unsigned int seed; // random state of ACCESS_RANDOM
+    Access_trace *trace; // page list of the process, NULL to touch pages in turn
+    long long accesses; // pages touched
+    long long faults; // touches of pages not in frames
+    long long ran; // time run, each time unit touching a page or waiting on a fault
+    int touch_head; // frame holding the page touched longest ago, -1 if none, only kept under LRU
+    int touch_tail; // frame holding the page touched last, -1 if none
+};
+
+Access_model* read_access_model(char *spec, long long latency);
+
+void free_access_model(Access_model *model);
+
+Page_table* new_page_table(Access_model *model, Process *p, int pages);
+
+void free_page_table(Page_table *pt);
+
+void map_frames(Frame_track *track, Process *p, int *frames, int cnt);
+
+long long access_pages(Frame_track *track, Process *p, long long elapsed, long long time_stamp);
+
+void print_page_faults(Process **proc_list, int cnt, long long latency);
+
+#endif
@@ -1,152 +1,155 @@
 #include "process_q.h"
+#include "stream.h"
 
 /**
- * Function to initialize a queue
+ * Function to initialize a process record.
  * 
- * Return: queue
+ * Input: 
+ * process record;
+ * process name;
+ * arrival time;
+ * service time;
+ * memory.
 */
-Queue* initialize_q() {
-    Queue *q = (Queue *)malloc(sizeof(Queue));
-    q->front = NULL;
-    q->rear = NULL;
-    return q;
+void initialize_p(Process *p, char *name, long long arr, long long serv, int mem) {
+    strcpy(p->pname, name);
+    p->arr_time = arr;
+    p->serv_time = serv;
+    p->rem_time = serv;
+    p->mem = mem;
+    p->complete_time = -1;
+    p->last_used = arr;
+    p->isInFrame = 0;
+    p->no_pageInFrames = 0;
+    p->frames = NULL;
+    p->frames_cap = 0;
+    p->pages_out = 0;
+    p->lru_prev = -1;
+    p->lru_next = -1;
+    p->addr = NULL;
+    p->buddy_at = -1;
+    p->level = 0;
+    p->slice_used = 0;
+    p->cpu = -1;
+    p->pt = NULL;
 }
 
 /**
- * Function to check if the queue is empty
+ * Function to return the index of the quantum in which a process is enqueued
 */
-int isEmpty(Queue *q) {
-    return (q->front == NULL);
+long long arrival_window(Process *p, int quantum){
+    if(p->arr_time <= 0) return 0;
+    return (p->arr_time + quantum - 1) / quantum;
 }
 
 /**
- * Function to insert a process to a queue
+ * Function to initialize an arrival cursor. Processes are merge sorted by the
+ * quantum they arrive in, keeping input order within a quantum, so they are
+ * enqueued in exactly the order a scan of the process list would produce.
+ *
+ * Return: arrival cursor
 */
-void enqueue(Queue *q, Process *p) {
-    Node *new = (Node *)malloc(sizeof(Node));
-    new->process = p;
-    new->next = NULL;
+Arrival_cursor* initialize_arrivals(Process **proc_list, int cnt, int quantum){
+    Arrival_cursor *arrivals = (Arrival_cursor *)malloc(sizeof(Arrival_cursor));
+    arrivals->order = (Process **)malloc(sizeof(Process*) * (cnt > 0 ? cnt : 1));
+    arrivals->cnt = cnt;
+    arrivals->next = 0;
+    arrivals->quantum = quantum;
+    arrivals->stream = NULL;
+    arrivals->arr_time = (long long *)malloc(sizeof(long long) * (cnt > 0 ? cnt : 1));
+    memcpy(arrivals->order, proc_list, sizeof(Process*) * cnt);
 
-    if (isEmpty(q)) {
-        q->front = new;
-    } else {
-        q->rear->next = new;
+    // traces are normally sorted already, so check before sorting
+    int sorted = 1;
+    for(int i = 1; i < cnt && sorted; i++){
+        if(arrival_window(proc_list[i-1], quantum) > arrival_window(proc_list[i], quantum)) sorted = 0;
     }
-    q->rear = new;
-}
-
-/**
- * Function to return the first process of the queue
-*/
-Process* dequeue(Queue *q) {
-    if (isEmpty(q)) {
-        printf("Queue is empty\n");
-        return (Process*)NULL;
+    if(sorted){
+        for(int i = 0; i < cnt; i++) arrivals->arr_time[i] = proc_list[i]->arr_time;
+        return arrivals;
     }
-    Node *temp = q->front;
-    Process *p = temp->process;
-    q->front = q->front->next;
 
-    if (q->front == NULL) {
-        q->rear = NULL;
+    // bottom-up merge sort, stable on input order
+    Process **src = arrivals->order;
+    Process **dst = (Process **)malloc(sizeof(Process*) * cnt);
+    for(int width = 1; width < cnt; width *= 2){
+        for(int lo = 0; lo < cnt; lo += 2 * width){
+            int mid = lo + width < cnt ? lo + width : cnt;
+            int hi = lo + 2 * width < cnt ? lo + 2 * width : cnt;
+            int i = lo, j = mid, k = lo;
+            while(i < mid && j < hi){
+                if(arrival_window(src[j], quantum) < arrival_window(src[i], quantum)) dst[k++] = src[j++];
+                else dst[k++] = src[i++];
+            }
+            while(i < mid) dst[k++] = src[i++];
+            while(j < hi) dst[k++] = src[j++];
+        }
+        Process **tmp = src;
+        src = dst;
+        dst = tmp;
     }
-
-    free(temp);
-    return p;
+    arrivals->order = src;
+    free(dst);
+    for(int i = 0; i < cnt; i++) arrivals->arr_time[i] = src[i]->arr_time;
+    return arrivals;
 }
 
 /**
- * Function to free queue
+ * Function to initialize an arrival cursor over a stream, which reads the
+ * processes in arrival order as they are taken
+ *
+ * Return: arrival cursor
 */
-void free_q(Queue *q) {
-    while (!isEmpty(q)) {
-        dequeue(q);
-    }
-    free(q);
+Arrival_cursor* stream_arrivals(Process_stream *stream){
+    Arrival_cursor *arrivals = (Arrival_cursor *)malloc(sizeof(Arrival_cursor));
+    arrivals->order = NULL;
+    arrivals->arr_time = NULL;
+    arrivals->cnt = 0;
+    arrivals->next = 0;
+    arrivals->quantum = stream->quantum;
+    arrivals->stream = stream;
+    return arrivals;
 }
 
 /**
- * Function to initialize a process.
- * 
- * Input: 
- * process name;
- * arrival time;
- * service time;
- * memory.
- * 
- * Return: a process.
+ * Function to take the next process that has arrived by a time stamp
+ *
+ * Return: the process, or NULL if the next one has not arrived yet
 */
-Process* initialize_p(char *name, int arr, int serv, int mem) {
-    Process *p = (Process *)malloc(sizeof(Process));
-    strcpy(p->pname, name);
-    p->arr_time = arr;
-    p->serv_time = serv;
-    p->rem_time = serv;
-    p->mem = mem;
-    p->complete_time = -1;
-    p->last_used = arr;
-    p->isInFrame = 0;
-    p->no_pageInFrames = 0;
-    p->addr = NULL;
-    return p;
+Process* take_arrival(Arrival_cursor *arrivals, long long time_stamp){
+    if(arrivals->stream) return stream_take(arrivals->stream, time_stamp);
+    if(arrivals->next == arrivals->cnt || arrivals->arr_time[arrivals->next] > time_stamp) return NULL;
+    return arrivals->order[arrivals->next++];
 }
 
 /**
- * Function to count how many instances in the queue
- * 
- * Return: the size of the queue
+ * Function to find the arrival time of the next process that has not arrived yet
+ *
+ * Return: the next arrival time, or -1 if every process has already arrived
 */
-int q_size(Queue *q){
-    int cnt = 0;
-    if (!isEmpty(q)) {
-        Node *tmp = q->front;
-        while (tmp != NULL) {
-            cnt++;
-            tmp = tmp->next;
-        }
-    }
-    return cnt;
+long long next_arrival(Arrival_cursor *arrivals){
+    if(arrivals->stream) return stream_next_arrival(arrivals->stream);
+    if(arrivals->next == arrivals->cnt) return -1;
+    return arrivals->arr_time[arrivals->next];
 }
 
 /**
- * Function to return the number of processes have not finished in a process list
+ * Function to free arrival cursor
 */
-int remaining_p(Process **proc_list, int cnt){
-    int rem = 0;
-    for(int i = 0; i < cnt; i++){
-        if(proc_list[i]->rem_time > 0){
-            rem++;
-        }
-    }
-    return rem;
+void free_arrivals(Arrival_cursor *arrivals){
+    free(arrivals->order);
+    free(arrivals->arr_time);
+    free(arrivals);
 }
 
 /**
- * Function to free every process in the process list.
+ * Function to free every process in the process list. The records are one
+ * slab, starting at the first process.
 */
 void free_process(Process **proc_list, int cnt){
     for(int i = 0; i < cnt; i++){
-        free(proc_list[i]);
+        free(proc_list[i]->frames);
     }
+    if(cnt > 0) free(proc_list[0]);
     free(proc_list);
-}
-
-/*
- * Function to find least recently used process which allocated memories in frame list
- *
- * Return: the least recently used process
-*/
-Process* find_LRU_proc(Queue *q) {
-    Process * lowest_proc;
-    if (!isEmpty(q)) {
-        Node *tmp = q->front;
-        lowest_proc = NULL;
-        while (tmp != NULL) {
-            if ((lowest_proc == NULL || tmp->process->last_used < lowest_proc->last_used) && tmp->process->isInFrame == 1) {
-                lowest_proc = tmp->process;
-            }
-            tmp = tmp->next;
-        }
-    }
-    return lowest_proc;
 }
\ No newline at end of file
@@ -6,52 +6,75 @@
 #include <string.h>
 
 #define MAX_NAME_LENGTH 8 // the maximum length of a process name
-#define MAX_DIGIT 10 // the upper bound of an integer is 2^32, which has 10 digits
 
 typedef struct Block Block;
+typedef struct Page_table Page_table;
 typedef struct Memory Memory;
+typedef struct Process_stream Process_stream;
 
+/**
+ * A process record. The fields the scheduling loop and the frame scans read
+ * on every quantum boundary come first, so they share the first cache line;
+ * the ones only read when a process starts, finishes or is reported follow.
+*/
 typedef struct Process{
-    char pname[MAX_NAME_LENGTH]; // process name
-    int arr_time; // arrival time
-    int serv_time; // service time
-    int rem_time; // remaining time
+    long long arr_time; // arrival time
+    long long rem_time; // remaining time
+    long long last_used; // the last time this process has runned
+    int id; // position of the process in the trace
+    int slot; // index of the record in its process table, what frames store instead of a pointer
+    int cpu; // CPU the process is running on, -1 if it is not running
+    int level; // MLFQ level the process is queued at
+    int slice_used; // quanta run since the process was last taken at its MLFQ level
     int mem; // memory
-    int complete_time; // time stamp when the process is completed
-    int last_used; // the last time this process has runned
     int isInFrame; // 0 if the process is not in frames, 1 if the process is in frames
     int no_pageInFrames; // number of pages that stored in frames
+    int *frames; // indices of the frames holding pages of this process, ascending
+    int lru_prev; // slot of the process in frames used less recently than this one, -1 if none
+    int lru_next; // slot of the process in frames used more recently than this one, -1 if none
+    int frames_cap; // capacity of frames
+    int pages_out; // pages evicted to make room for another process and not loaded back yet
     Block *addr; // the block this process is allocated at
+    int buddy_at; // start of the buddy block this process is allocated at, -1 if none
+    long long serv_time; // service time
+    long long complete_time; // time stamp when the process is completed
+    Page_table *pt; // pages of the process under demand paging, NULL unless -A is given
+    char pname[MAX_NAME_LENGTH + 1]; // process name
 } Process;
 
-typedef struct Node {
-    Process *process;
-    struct Node *next;
-} Node;
+/**
+ * Every process record of a run by slot: the process list, or the records of
+ * a stream, which grows as it reads more processes at once. Frames, the
+ * recency list and the ready processes refer to processes by slot.
+*/
+typedef struct Process_table{
+    Process **at; // record of each slot
+    int cnt; // number of slots
+} Process_table;
 
 typedef struct {
-    Node *front;
-    Node *rear;
-} Queue;
+    Process **order; // processes sorted by the quantum they arrive in, stable on input order
+    long long *arr_time; // arrival time of each process in order, so the cursor scans one array
+    int cnt; // number of processes
+    int next; // index of the first process that has not arrived yet
+    int quantum; // quantum the arrival windows are measured in
+    Process_stream *stream; // reads the processes as they arrive instead of order, NULL if none
+} Arrival_cursor;
 
-Queue* initialize_q();
+long long arrival_window(Process *p, int quantum);
 
-int isEmpty(Queue *q);
+Arrival_cursor* initialize_arrivals(Process **proc_list, int cnt, int quantum);
 
-void enqueue(Queue *q, Process *p);
+Arrival_cursor* stream_arrivals(Process_stream *stream);
 
-Process* dequeue(Queue *q);
+Process* take_arrival(Arrival_cursor *arrivals, long long time_stamp);
 
-void free_q(Queue *q);
+long long next_arrival(Arrival_cursor *arrivals);
 
-int q_size(Queue *q);
+void free_arrivals(Arrival_cursor *arrivals);
 
-int remaining_p(Process **proc_list, int cnt);
-
-Process* initialize_p(char *name, int arr, int serv, int mem);
+void initialize_p(Process *p, char *name, long long arr, long long serv, int mem);
 
 void free_process(Process **proc_list, int cnt);
 
-Process* find_LRU_proc(Queue *q);
-
 #endif
\ No newline at end of file
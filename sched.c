@@ -0,0 +1,361 @@
+#include "sched.h"
+
+/**
+ * Function to give the slice of an MLFQ level in quanta, doubling at each level
+*/
+static int mlfq_slice(int level){
+    return 1 << level;
+}
+
+/**
+ * Function to check if the process of node a runs before the one of node b
+ * under SRTF, by remaining time and then by position in the trace
+*/
+static int srtf_before(Ready_node *a, Ready_node *b){
+    return a->rem_time < b->rem_time || (a->rem_time == b->rem_time && a->id < b->id);
+}
+
+/**
+ * Function to give the treap priority of a node, a hash of its process id
+*/
+static unsigned int node_priority(Ready_node *n){
+    unsigned int x = (unsigned int)n->id * 2654435761u;
+    x ^= x >> 16;
+    return x * 2246822519u;
+}
+
+/**
+ * Function to count the nodes of a subtree
+*/
+static int subtree_count(Ready_node *t){
+    return t == NULL ? 0 : t->count;
+}
+
+/**
+ * Function to recompute the count and least demand of a node from its children
+*/
+static void update(Ready_node *t){
+    t->count = 1 + subtree_count(t->left) + subtree_count(t->right);
+    t->min_demand = t->demand;
+    if(t->left && t->left->min_demand < t->min_demand) t->min_demand = t->left->min_demand;
+    if(t->right && t->right->min_demand < t->min_demand) t->min_demand = t->right->min_demand;
+}
+
+/**
+ * Function to join two treaps, every node of a being taken before every node of b
+ *
+ * Return: the joined treap
+*/
+static Ready_node* merge(Ready_node *a, Ready_node *b){
+    if(a == NULL) return b;
+    if(b == NULL) return a;
+    if(node_priority(a) >= node_priority(b)){
+        a->right = merge(a->right, b);
+        update(a);
+        return a;
+    }
+    b->left = merge(a, b->left);
+    update(b);
+    return b;
+}
+
+/**
+ * Function to split an SRTF treap into the nodes SRTF takes before node p and the rest
+*/
+static void split_before(Ready_node *t, Ready_node *p, Ready_node **before, Ready_node **after){
+    if(t == NULL){
+        *before = *after = NULL;
+        return;
+    }
+    if(srtf_before(t, p)){
+        split_before(t->right, p, &t->right, after);
+        update(t);
+        *before = t;
+    }else{
+        split_before(t->left, p, before, &t->left);
+        update(t);
+        *after = t;
+    }
+}
+
+/**
+ * Function to join two SRTF treaps in any order, keeping them ordered by
+ * remaining time then id
+ *
+ * Return: the joined treap
+*/
+static Ready_node* unite(Ready_node *a, Ready_node *b){
+    if(a == NULL) return b;
+    if(b == NULL) return a;
+    if(node_priority(a) < node_priority(b)){
+        Ready_node *t = a;
+        a = b;
+        b = t;
+    }
+    Ready_node *before, *after;
+    split_before(b, a, &before, &after);
+    a->left = unite(a->left, before);
+    a->right = unite(a->right, after);
+    update(a);
+    return a;
+}
+
+/**
+ * Function to unlink the first node of a treap whose demand is at most room,
+ * splitting the rest into the nodes before it and the nodes after it. Subtrees
+ * where no demand is small enough are passed over whole.
+ *
+ * Return: the node, or NULL if none fits and every node is before
+*/
+static Ready_node* split_fit(Ready_node *t, int room, Ready_node **before, Ready_node **after){
+    if(t == NULL || t->min_demand > room){
+        *before = t;
+        *after = NULL;
+        return NULL;
+    }
+    Ready_node *fit;
+    if(t->left && t->left->min_demand <= room){
+        fit = split_fit(t->left, room, before, &t->left);
+        update(t);
+        *after = t;
+    }else if(t->demand <= room){
+        fit = t;
+        *before = t->left;
+        *after = t->right;
+        t->left = t->right = NULL;
+    }else{
+        fit = split_fit(t->right, room, &t->right, after);
+        update(t);
+        *before = t;
+    }
+    return fit;
+}
+
+/**
+ * Function to take a node for a process from the node pool, growing the pool
+ * by a chunk when it is empty
+*/
+static Ready_node* new_node(Ready *r, Process *p, int demand){
+    if(r->spare == NULL){
+        Ready_chunk *chunk = (Ready_chunk*)malloc(sizeof(Ready_chunk));
+        chunk->next = r->chunks;
+        r->chunks = chunk;
+        for(int i = 0; i < READY_CHUNK; i++){
+            chunk->nodes[i].right = r->spare;
+            r->spare = &chunk->nodes[i];
+        }
+    }
+    Ready_node *n = r->spare;
+    r->spare = n->right;
+    n->rem_time = p->rem_time;
+    n->slot = p->slot;
+    n->id = p->id;
+    n->demand = demand;
+    n->left = n->right = NULL;
+    update(n);
+    return n;
+}
+
+/**
+ * Function to add a node to the processes of its level, at the back of the
+ * FIFO or in order of remaining time for SRTF
+*/
+static void level_add(Ready *r, Ready_node **levels, Ready_node *n){
+    if(r->scheduler == SRTF) levels[0] = unite(levels[0], n);
+    else if(r->scheduler == MLFQ){
+        int level = r->procs->at[n->slot]->level;
+        levels[level] = merge(levels[level], n);
+    }
+    else levels[0] = merge(levels[0], n);
+}
+
+/**
+ * Function to write the ids of a treap in the order the scheduler takes them
+ *
+ * Return: number of ids written
+*/
+static int list_ids(Ready_node *t, int *ids){
+    if(t == NULL) return 0;
+    int cnt = list_ids(t->left, ids);
+    ids[cnt++] = t->id;
+    return cnt + list_ids(t->right, ids + cnt);
+}
+
+/**
+ * Function to find the first non-empty MLFQ level
+ *
+ * Return: the level, or MLFQ_LEVELS if no process is ready
+*/
+static int top_level(Ready *r){
+    int level = 0;
+    while(level < MLFQ_LEVELS && r->levels[level] == NULL) level++;
+    return level;
+}
+
+/**
+ * Function to initialize the ready processes of a scheduler
+ *
+ * Return: Ready*
+*/
+Ready* initialize_ready(int scheduler, Process_table *procs){
+    Ready *r = (Ready*)malloc(sizeof(Ready));
+    r->scheduler = scheduler;
+    r->size = 0;
+    r->procs = procs;
+    for(int i = 0; i < MLFQ_LEVELS; i++) r->levels[i] = r->aside[i] = NULL;
+    r->spare = NULL;
+    r->chunks = NULL;
+    return r;
+}
+
+/**
+ * Function to check if no process is ready
+*/
+int ready_empty(Ready *r){
+    return r->size == 0;
+}
+
+/**
+ * Function to return how many processes are ready
+*/
+int ready_size(Ready *r){
+    return r->size;
+}
+
+/**
+ * Function to add a process that arrived or stopped running to the ready
+ * processes. demand is the memory it needs before it can run, compared with
+ * the room given to ready_take, and 0 if it fits as it is.
+*/
+void ready_add(Ready *r, Process *p, int demand){
+    STAT_ADD(queue_ops, 1);
+    level_add(r, r->levels, new_node(r, p, demand));
+    r->size++;
+}
+
+/**
+ * Function to take the first process the scheduler would run among those
+ * whose demand is at most room. The processes before it are set aside as a
+ * whole, as if each had been taken and passed over.
+ *
+ * Return: the process, or NULL if none fits
+*/
+Process* ready_take(Ready *r, int room){
+    STAT_ADD(queue_ops, 1);
+    for(int level = 0; level < MLFQ_LEVELS; level++){
+        Ready_node *before, *after;
+        Ready_node *n = split_fit(r->levels[level], room, &before, &after);
+        r->size -= subtree_count(before);
+        if(r->scheduler == SRTF) r->aside[level] = unite(r->aside[level], before);
+        else r->aside[level] = merge(r->aside[level], before);
+        r->levels[level] = after;
+        if(n == NULL) continue;
+
+        Process *p = r->procs->at[n->slot];
+        n->right = r->spare;
+        r->spare = n;
+        r->size--;
+        if(r->scheduler == MLFQ) p->slice_used = 0;
+        return p;
+    }
+    return NULL;
+}
+
+/**
+ * Function to check if the scheduler switches away from the running process
+ * at this quantum boundary. When it does, the running process is added back
+ * and another one is taken.
+*/
+int ready_preempts(Ready *r, Process *running){
+    if(ready_empty(r)) return 0;
+    if(running == NULL || r->scheduler == RR) return 1;
+    if(r->scheduler == SRTF){
+        Ready_node *top = r->levels[0];
+        while(top->left) top = top->left;
+        return top->rem_time < running->rem_time;
+    }
+    // a process waiting at a higher level, or at the same level once the slice is
+    // used up; a process that has run since it was taken only has no slice used then
+    int top = top_level(r);
+    return top < running->level || (top == running->level && running->slice_used == 0);
+}
+
+/**
+ * Function to count the quanta until the scheduler may switch on its own,
+ * as opposed to a process arriving or finishing
+ *
+ * Return: number of quanta, or -1 if it only switches when processes arrive or finish
+*/
+long long ready_horizon(Ready *r, Process *running){
+    if(ready_empty(r)) return -1;
+    if(running == NULL || r->scheduler == RR) return 1;
+    if(r->scheduler == SRTF) return -1;
+    if(top_level(r) < running->level) return 1;
+    return mlfq_slice(running->level) - running->slice_used;
+}
+
+/**
+ * Function to account quanta the running process has just run, demoting it
+ * one MLFQ level for each slice it uses up
+*/
+void ready_ran(Ready *r, Process *running, long long quanta){
+    if(r->scheduler != MLFQ) return;
+    long long used = running->slice_used + quanta;
+    while(running->level < MLFQ_LEVELS - 1 && used >= mlfq_slice(running->level)){
+        used -= mlfq_slice(running->level);
+        running->level++;
+    }
+    if(used >= mlfq_slice(running->level)){
+        // the last level keeps the process, starting a new slice
+        used %= mlfq_slice(running->level);
+    }
+    running->slice_used = (int)used;
+}
+
+/**
+ * Function to pass over a process taken to run that does not fit in memory
+ * yet. It is added back by ready_restore once another process has been taken.
+*/
+void ready_set_aside(Ready *r, Process *p, int demand){
+    STAT_ADD(queue_ops, 1);
+    level_add(r, r->aside, new_node(r, p, demand));
+}
+
+/**
+ * Function to add back every process passed over, each level after the
+ * processes added to it since, in the order they were taken
+*/
+void ready_restore(Ready *r){
+    STAT_ADD(queue_ops, 1);
+    for(int level = 0; level < MLFQ_LEVELS; level++){
+        r->size += subtree_count(r->aside[level]);
+        if(r->scheduler == SRTF) r->levels[level] = unite(r->levels[level], r->aside[level]);
+        else r->levels[level] = merge(r->levels[level], r->aside[level]);
+        r->aside[level] = NULL;
+    }
+}
+
+/**
+ * Function to list the ids of the ready processes, level by level in the
+ * order they are taken. Adding them back in this order with ready_add
+ * rebuilds the same ready processes.
+ *
+ * Return: number of ids written to ids
+*/
+int ready_list(Ready *r, int *ids){
+    int cnt = 0;
+    for(int level = 0; level < MLFQ_LEVELS; level++) cnt += list_ids(r->levels[level], ids + cnt);
+    return cnt;
+}
+
+/**
+ * Function to free the ready processes
+*/
+void free_ready(Ready *r){
+    while(r->chunks){
+        Ready_chunk *next = r->chunks->next;
+        free(r->chunks);
+        r->chunks = next;
+    }
+    free(r);
+}
@@ -0,0 +1,76 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "process_q.h"
+#include "stats.h"
+
+// schedulers choosing the next process to run from the ready processes
+#define RR 0 // round robin, every process runs a quantum in turn
+#define SRTF 1 // shortest remaining time first, preempting at quantum boundaries
+#define MLFQ 2 // multi-level feedback queue, demoting processes that use up their slice
+
+#define MLFQ_LEVELS 3 // number of MLFQ levels, level 0 runs first
+#define READY_CHUNK 256 // number of nodes the node pool of the ready processes grows by
+
+/**
+ * A ready process in a treap ordered the way the scheduler takes processes.
+ * A node refers to its process by slot and keeps what the order compares, so
+ * the treap is walked without loading a process record.
+ * Each subtree keeps its least memory demand, so the first process that fits
+ * is found without visiting the ones that do not. SRTF uses such a treap too,
+ * ordered by remaining time, in place of a binary heap: a heap gives only its
+ * first process, so every process before the first that fits had to be popped.
+*/
+typedef struct Ready_node{
+    long long rem_time; // remaining time of the process, which does not change while it is ready
+    int slot; // slot of the process in the process table
+    int id; // position of the process in the trace, SRTF breaks ties on it and hashes it for the treap priority
+    int demand; // memory the process needs before it can run, 0 if it can run as it is
+    int min_demand; // least demand in the subtree
+    int count; // number of nodes in the subtree
+    struct Ready_node *left; // nodes taken before this one
+    struct Ready_node *right; // nodes taken after this one
+} Ready_node;
+
+typedef struct Ready_chunk {
+    struct Ready_chunk *next; // the chunk allocated before this one
+    Ready_node nodes[READY_CHUNK];
+} Ready_chunk;
+
+typedef struct Ready{
+    int scheduler; // RR, SRTF or MLFQ
+    int size; // number of ready processes, not counting those set aside
+    Process_table *procs; // the processes the slots of the nodes refer to
+    Ready_node *levels[MLFQ_LEVELS]; // FIFO of each MLFQ level, RR only uses level 0, SRTF keeps level 0 by remaining time then id
+    Ready_node *aside[MLFQ_LEVELS]; // processes of each level passed over because they do not fit in memory yet
+    Ready_node *spare; // pool of unused nodes, linked through right
+    Ready_chunk *chunks; // every chunk the node pool has allocated
+} Ready;
+
+Ready* initialize_ready(int scheduler, Process_table *procs);
+
+int ready_empty(Ready *r);
+
+int ready_size(Ready *r);
+
+void ready_add(Ready *r, Process *p, int demand);
+
+Process* ready_take(Ready *r, int room);
+
+int ready_preempts(Ready *r, Process *running);
+
+long long ready_horizon(Ready *r, Process *running);
+
+void ready_ran(Ready *r, Process *running, long long quanta);
+
+void ready_set_aside(Ready *r, Process *p, int demand);
+
+void ready_restore(Ready *r);
+
+int ready_list(Ready *r, int *ids);
+
+void free_ready(Ready *r);
+
+#endif
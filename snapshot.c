@@ -0,0 +1,341 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+
+/**
+ * Function to round a section offset up to a multiple of 8 bytes
+*/
+static long long align_section(long long off){
+    return (off + 7) & ~7LL;
+}
+
+/**
+ * Function to save the state of a run shared by every memory allocation
+ * method: the process table, the ready processes and the running ones.
+ * The memory manager adds its own sections before the snapshot is written.
+ *
+ * Input:
+ * ck: the checkpoint, giving the method and options of the run;
+ * process list and p_cnt;
+ * time_stamp: the quantum boundary the run is saved at;
+ * rem_p: processes that have not finished running;
+ * the ready processes, the process running on each CPU and the arrivals.
+ *
+ * Return: the snapshot, freed with free_snapshot
+*/
+Snapshot* save_run(Checkpoint *ck, Process **proc_list, int p_cnt, long long time_stamp, int rem_p,
+    Ready *ready, Process **running, Arrival_cursor *arrivals){
+    Snapshot *s = (Snapshot*)calloc(1, sizeof(Snapshot));
+    Snapshot_header *h = (Snapshot_header*)malloc(sizeof(Snapshot_header));
+    *h = ck->settings;
+    memcpy(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic));
+    h->header_size = sizeof(Snapshot_header);
+    h->time_stamp = time_stamp;
+    h->rem_p = rem_p;
+    h->p_cnt = p_cnt;
+    h->block_cnt = 0;
+    h->frame_cnt = 0;
+    h->lru_cnt = 0;
+    h->fifo_cnt = 0;
+    h->has_policy = 0;
+    h->cursor = 0;
+    h->evictions = 0;
+    h->refaults = 0;
+    h->compactions = 0;
+    h->moved = 0;
+    s->header = h;
+
+    s->processes = (Snapshot_process*)calloc(p_cnt > 0 ? p_cnt : 1, sizeof(Snapshot_process));
+    for (int i = 0; i < arrivals->next; i++) s->processes[arrivals->order[i]->id].arrived = 1;
+    for (int i = 0; i < p_cnt; i++) {
+        Process *p = proc_list[i];
+        Snapshot_process *r = &s->processes[i];
+        strncpy(r->pname, p->pname, MAX_NAME_LENGTH);
+        r->arr_time = p->arr_time;
+        r->serv_time = p->serv_time;
+        r->rem_time = p->rem_time;
+        r->complete_time = p->complete_time;
+        r->last_used = p->last_used;
+        r->mem = p->mem;
+        r->isInFrame = p->isInFrame;
+        r->pages_out = p->pages_out;
+        r->buddy_at = p->buddy_at;
+        r->level = p->level;
+        r->slice_used = p->slice_used;
+    }
+
+    s->ready = (int*)malloc(sizeof(int) * (ready_size(ready) > 0 ? ready_size(ready) : 1));
+    h->ready_cnt = ready_list(ready, s->ready);
+    s->running = (int*)malloc(sizeof(int) * h->cpus);
+    for (int c = 0; c < h->cpus; c++) s->running[c] = running[c] ? running[c]->id : -1;
+    return s;
+}
+
+/**
+ * Function to resume a run from a snapshot: processes in the snapshot get
+ * their saved state back, and processes after them in the trace are new
+ * arrivals. The memory manager restores its own sections, and the ready
+ * processes in s->ready are added back once it has.
+ *
+ * Input:
+ * s: the snapshot;
+ * process list and p_cnt, starting with the processes of the snapshot;
+ * quantum: quantum length;
+ * time_stamp and rem_p: set to the time stamp and the processes remaining;
+ * running: set to the process running on each CPU.
+ *
+ * Return: the arrival cursor over the processes that have not arrived yet
+*/
+Arrival_cursor* resume_run(Snapshot *s, Process **proc_list, int p_cnt, int quantum, long long *time_stamp,
+    int *rem_p, Process **running){
+    Snapshot_header *h = s->header;
+    Process **pending = (Process**)malloc(sizeof(Process*) * (p_cnt > 0 ? p_cnt : 1));
+    int pending_cnt = 0;
+    for (int i = 0; i < p_cnt; i++) {
+        Process *p = proc_list[i];
+        if (i >= h->p_cnt) {
+            // appended to the trace after the snapshot was taken
+            pending[pending_cnt++] = p;
+            continue;
+        }
+        Snapshot_process *r = &s->processes[i];
+        p->rem_time = r->rem_time;
+        p->complete_time = r->complete_time;
+        p->last_used = r->last_used;
+        p->isInFrame = r->isInFrame;
+        p->pages_out = r->pages_out;
+        p->buddy_at = r->buddy_at;
+        p->level = r->level;
+        p->slice_used = r->slice_used;
+        if (!r->arrived) pending[pending_cnt++] = p;
+    }
+
+    for (int c = 0; c < h->cpus; c++) {
+        running[c] = s->running[c] == -1 ? NULL : proc_list[s->running[c]];
+        if (running[c]) running[c]->cpu = c;
+    }
+    *time_stamp = h->time_stamp;
+    *rem_p = h->rem_p + p_cnt - h->p_cnt;
+
+    // the pending processes keep the order they had in the arrivals
+    Arrival_cursor *arrivals = initialize_arrivals(pending, pending_cnt, quantum);
+    free(pending);
+    return arrivals;
+}
+
+/**
+ * Function to write a section of a snapshot at its offset, padding up to it
+*/
+static void write_section(FILE *f, long long *pos, long long off, void *data, size_t len){
+    static const char zeros[8];
+    while (*pos < off) {
+        int pad = off - *pos < 8 ? (int)(off - *pos) : 8;
+        fwrite(zeros, 1, pad, f);
+        *pos += pad;
+    }
+    if (len > 0) fwrite(data, 1, len, f);
+    *pos += len;
+}
+
+/**
+ * Function to write a snapshot to a file, laying out its sections one after
+ * another at 8-byte aligned offsets recorded in the header
+ *
+ * Return: 0 for success or -1 if the file cannot be written
+*/
+int write_snapshot(char *path, Snapshot *s){
+    Snapshot_header *h = s->header;
+    int frames = h->has_policy ? h->frame_cnt : 0;
+    long long off = sizeof(Snapshot_header);
+    h->off_processes = off = align_section(off);
+    off += sizeof(Snapshot_process) * (long long)h->p_cnt;
+    h->off_ready = off = align_section(off);
+    off += sizeof(int) * (long long)h->ready_cnt;
+    h->off_running = off = align_section(off);
+    off += sizeof(int) * (long long)h->cpus;
+    h->off_blocks = off = align_section(off);
+    off += sizeof(Snapshot_block) * (long long)h->block_cnt;
+    h->off_owners = off = align_section(off);
+    off += sizeof(int) * (long long)h->frame_cnt;
+    h->off_lru = off = align_section(off);
+    off += sizeof(int) * (long long)h->lru_cnt;
+    h->off_fifo = off = align_section(off);
+    off += sizeof(int) * (long long)h->fifo_cnt;
+    h->off_referenced = off = align_section(off);
+    off += frames;
+    h->off_use_count = off = align_section(off);
+    off += sizeof(int) * (long long)frames;
+    h->off_last_ref = off = align_section(off);
+    off += sizeof(long long) * (long long)frames;
+    h->size = off;
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) return -1;
+    long long pos = 0;
+    write_section(f, &pos, 0, h, sizeof(Snapshot_header));
+    write_section(f, &pos, h->off_processes, s->processes, sizeof(Snapshot_process) * h->p_cnt);
+    write_section(f, &pos, h->off_ready, s->ready, sizeof(int) * h->ready_cnt);
+    write_section(f, &pos, h->off_running, s->running, sizeof(int) * h->cpus);
+    write_section(f, &pos, h->off_blocks, s->blocks, sizeof(Snapshot_block) * h->block_cnt);
+    write_section(f, &pos, h->off_owners, s->owners, sizeof(int) * h->frame_cnt);
+    write_section(f, &pos, h->off_lru, s->lru, sizeof(int) * h->lru_cnt);
+    write_section(f, &pos, h->off_fifo, s->fifo, sizeof(int) * h->fifo_cnt);
+    write_section(f, &pos, h->off_referenced, s->referenced, frames);
+    write_section(f, &pos, h->off_use_count, s->use_count, sizeof(int) * frames);
+    write_section(f, &pos, h->off_last_ref, s->last_ref, sizeof(long long) * frames);
+    return fclose(f) == 0 && pos == h->size ? 0 : -1;
+}
+
+/**
+ * Function to check that a section of cnt entries of a given size lies in the snapshot
+*/
+static int section_fits(Snapshot_header *h, long long off, long long cnt, long long size){
+    return cnt >= 0 && off >= (long long)sizeof(Snapshot_header) && off % 8 == 0 && off + cnt * size <= h->size;
+}
+
+/**
+ * Function to check that every id of a section is a process of the snapshot,
+ * or -1 where a section may have no process
+*/
+static int ids_valid(int *ids, int cnt, int p_cnt, int allow_none){
+    for (int i = 0; i < cnt; i++) {
+        if (ids[i] >= p_cnt || ids[i] < (allow_none ? -1 : 0)) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Function to check that the process table agrees with the ready and running
+ * processes: every process that has arrived and not finished is either ready
+ * or running, exactly once, and rem_p counts the processes that have not
+ * finished running
+*/
+static int run_valid(Snapshot *s){
+    Snapshot_header *h = s->header;
+    char *seen = (char*)calloc(h->p_cnt > 0 ? h->p_cnt : 1, 1);
+    int valid = 1;
+    for (int i = 0; i < h->ready_cnt + h->cpus && valid; i++) {
+        int id = i < h->ready_cnt ? s->ready[i] : s->running[i - h->ready_cnt];
+        if (id == -1) continue;
+        if (seen[id]) valid = 0;
+        seen[id] = i < h->ready_cnt ? 1 : 2;
+    }
+    int rem = 0;
+    for (int i = 0; i < h->p_cnt && valid; i++) {
+        Snapshot_process *r = &s->processes[i];
+        if (r->rem_time < 0 || r->rem_time > r->serv_time || r->mem < 0 || (r->arrived & ~1) || (r->isInFrame & ~1) ||
+            r->pages_out < 0 || r->buddy_at < -1 || r->level < 0 || r->level >= MLFQ_LEVELS || r->slice_used < 0) valid = 0;
+        if ((seen[i] != 0) != (r->arrived && r->complete_time == -1)) valid = 0;
+        if (!r->arrived && r->rem_time != r->serv_time) valid = 0;
+        // a running process that has just finished is no longer counted
+        if (r->complete_time == -1 && !(seen[i] == 2 && r->rem_time == 0)) rem++;
+    }
+    free(seen);
+    return valid && rem == h->rem_p;
+}
+
+/**
+ * Function to map a snapshot file and check its layout. Sections are used
+ * in place, nothing is copied.
+ *
+ * Return: the snapshot, or NULL if the file cannot be read or is not a snapshot
+*/
+Snapshot* open_snapshot(char *path){
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(Snapshot_header)) {
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    Snapshot_header *h = (Snapshot_header*)map;
+    int frames = h->has_policy ? h->frame_cnt : 0;
+    if (memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic)) != 0 || h->header_size != sizeof(Snapshot_header) ||
+        h->size != st.st_size || h->p_cnt < 0 || h->cpus < 1 || h->rem_p < 0 || h->rem_p > h->p_cnt ||
+        h->compactions < 0 || h->moved < 0 ||
+        memchr(h->method, '\0', METHOD_LENGTH) == NULL ||
+        !section_fits(h, h->off_processes, h->p_cnt, sizeof(Snapshot_process)) ||
+        !section_fits(h, h->off_ready, h->ready_cnt, sizeof(int)) ||
+        !section_fits(h, h->off_running, h->cpus, sizeof(int)) ||
+        !section_fits(h, h->off_blocks, h->block_cnt, sizeof(Snapshot_block)) ||
+        !section_fits(h, h->off_owners, h->frame_cnt, sizeof(int)) ||
+        !section_fits(h, h->off_lru, h->lru_cnt, sizeof(int)) ||
+        !section_fits(h, h->off_fifo, h->fifo_cnt, sizeof(int)) ||
+        !section_fits(h, h->off_referenced, frames, 1) ||
+        !section_fits(h, h->off_use_count, frames, sizeof(int)) ||
+        !section_fits(h, h->off_last_ref, frames, sizeof(long long))) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    Snapshot *s = (Snapshot*)calloc(1, sizeof(Snapshot));
+    char *base = (char*)map;
+    s->map = map;
+    s->header = h;
+    s->processes = (Snapshot_process*)(base + h->off_processes);
+    s->ready = (int*)(base + h->off_ready);
+    s->running = (int*)(base + h->off_running);
+    s->blocks = (Snapshot_block*)(base + h->off_blocks);
+    s->owners = (int*)(base + h->off_owners);
+    s->lru = (int*)(base + h->off_lru);
+    s->fifo = (int*)(base + h->off_fifo);
+    s->referenced = (unsigned char*)(base + h->off_referenced);
+    s->use_count = (int*)(base + h->off_use_count);
+    s->last_ref = (long long*)(base + h->off_last_ref);
+
+    // sections refer to processes and frames by index, so check every index
+    int valid = ids_valid(s->ready, h->ready_cnt, h->p_cnt, 0) && ids_valid(s->running, h->cpus, h->p_cnt, 1) &&
+        ids_valid(s->owners, h->frame_cnt, h->p_cnt, 1) && ids_valid(s->lru, h->lru_cnt, h->p_cnt, 0) &&
+        ids_valid(s->fifo, h->fifo_cnt, h->frame_cnt, 0);
+    for (int i = 0; i < h->block_cnt && valid; i++) {
+        if (s->blocks[i].pid < -1 || s->blocks[i].pid >= h->p_cnt) valid = 0;
+    }
+    if (!valid || !run_valid(s)) {
+        free_snapshot(s);
+        return NULL;
+    }
+    return s;
+}
+
+/**
+ * Function to check that the process list starts with the processes of a
+ * snapshot, as they were in the trace the snapshot was taken from
+*/
+int snapshot_matches(Snapshot *s, Process **proc_list, int p_cnt){
+    if (p_cnt < s->header->p_cnt) return 0;
+    for (int i = 0; i < s->header->p_cnt; i++) {
+        Snapshot_process *r = &s->processes[i];
+        Process *p = proc_list[i];
+        if (strncmp(r->pname, p->pname, MAX_NAME_LENGTH) != 0 || r->arr_time != p->arr_time ||
+            r->serv_time != p->serv_time || r->mem != p->mem) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Function to free a snapshot, unmapping it if it was read from a file
+*/
+void free_snapshot(Snapshot *s){
+    if (s->map) {
+        munmap(s->map, s->header->size);
+    } else {
+        free(s->header);
+        free(s->processes);
+        free(s->ready);
+        free(s->running);
+        free(s->blocks);
+        free(s->owners);
+        free(s->lru);
+        free(s->fifo);
+        free(s->referenced);
+        free(s->use_count);
+        free(s->last_ref);
+    }
+    free(s);
+}
@@ -0,0 +1,117 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "process_q.h"
+#include "sched.h"
+
+#define SNAPSHOT_MAGIC "ALLOCCK1" // first bytes of a snapshot
+#define METHOD_LENGTH 16 // room for the method name in a snapshot
+
+typedef struct Snapshot_header{
+    char magic[8]; // SNAPSHOT_MAGIC
+    int header_size; // size of a Snapshot_header, to reject snapshots of another layout
+    char method[METHOD_LENGTH]; // memory allocation method of the run
+    int quantum; // quantum length
+    int scheduler; // RR, SRTF or MLFQ
+    int cpus; // number of CPUs
+    int policy; // page replacement policy for virtual, -1 if not given
+    int memory_size; // size of contiguous and buddy memory
+    int frame_number; // number of frames for paged and virtual
+    int page_size; // page and frame size for paged and virtual
+    int rem_p; // processes that have not finished running
+    long long time_stamp; // quantum boundary the snapshot was taken at
+    int p_cnt; // entries of the process table
+    int ready_cnt; // ready processes, in the order the scheduler keeps them
+    int block_cnt; // blocks of contiguous memory, or free blocks of buddy memory
+    int frame_cnt; // entries of the frame owner list, 0 unless paged or virtual
+    int lru_cnt; // processes in frames, least recently used first
+    int fifo_cnt; // frames in load order, for SECOND_CHANCE
+    int has_policy; // 1 if the per-frame state of a policy other than LRU follows
+    int cursor; // next fit rover, or CLOCK hand
+    int evictions; // pages evicted to make room for another process
+    int refaults; // evicted pages that were loaded into frames again
+    int compact; // 1 if contiguous memory is compacted when no hole fits
+    int compactions; // times contiguous memory was compacted
+    long long moved; // memory moved by compactions
+    // offsets of the sections from the start of the snapshot
+    long long off_processes;
+    long long off_ready;
+    long long off_running;
+    long long off_blocks;
+    long long off_owners;
+    long long off_lru;
+    long long off_fifo;
+    long long off_referenced;
+    long long off_use_count;
+    long long off_last_ref;
+    long long size; // size of the whole snapshot
+} Snapshot_header;
+
+typedef struct Snapshot_process{
+    char pname[MAX_NAME_LENGTH]; // process name, not terminated if it is 8 characters long
+    long long arr_time; // arrival time
+    long long serv_time; // service time
+    long long rem_time; // remaining time
+    long long complete_time; // time stamp when the process is completed, -1 if not yet
+    long long last_used; // the last time the process has run
+    int mem; // memory
+    int arrived; // 1 if the process has been taken from the arrivals
+    int isInFrame; // 1 if the process is in the recency list of frames
+    int pages_out; // pages evicted and not loaded back yet
+    int buddy_at; // start of its buddy block, -1 if none
+    int level; // MLFQ level
+    int slice_used; // quanta run at its MLFQ level
+    int pad; // keeps the record a multiple of 8 bytes
+} Snapshot_process;
+
+typedef struct Snapshot_block{
+    int start; // where the block starts
+    int size; // size of the block
+    int pid; // process allocated at the block, -1 for a hole or a free buddy block
+} Snapshot_block;
+
+/**
+ * A snapshot either built by a run that is saved or mapped from a file.
+ * Sections refer to processes by their position in the trace, never by address.
+*/
+typedef struct Snapshot{
+    Snapshot_header *header;
+    Snapshot_process *processes;
+    int *ready; // ids of the ready processes
+    int *running; // id of the process running on each CPU, -1 if idle
+    Snapshot_block *blocks;
+    int *owners; // id of the process in each frame, -1 if free
+    int *lru; // ids of the processes in frames, least recently used first
+    int *fifo; // frames in load order
+    unsigned char *referenced; // reference bit of each frame
+    int *use_count; // references of each frame since it was loaded
+    long long *last_ref; // time each frame was last referenced
+    void *map; // the mapped file, NULL if the sections were allocated
+} Snapshot;
+
+typedef struct Checkpoint{
+    long long at; // time stamp to save the run at, -1 to run to the end
+    char *path; // where the snapshot is written
+    int saved; // 1 once the snapshot is written
+    Snapshot_header settings; // method and options the snapshot records
+    Snapshot *resume; // snapshot the run resumes from, NULL to start at time 0
+} Checkpoint;
+
+Snapshot* save_run(Checkpoint *ck, Process **proc_list, int p_cnt, long long time_stamp, int rem_p,
+    Ready *ready, Process **running, Arrival_cursor *arrivals);
+
+Arrival_cursor* resume_run(Snapshot *s, Process **proc_list, int p_cnt, int quantum, long long *time_stamp,
+    int *rem_p, Process **running);
+
+int write_snapshot(char *path, Snapshot *s);
+
+Snapshot* open_snapshot(char *path);
+
+int snapshot_matches(Snapshot *s, Process **proc_list, int p_cnt);
+
+void free_snapshot(Snapshot *s);
+
+#endif
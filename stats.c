@@ -0,0 +1,44 @@
+#include "stats.h"
+
+__thread Run_stats run_stats;
+
+static char *phase_names[PHASE_NUMBER] = {"parse", "arrival", "allocation", "eviction", "output", "schedule"};
+
+/**
+ * Function to turn the counters on and start timing the parse phase
+*/
+void stats_start(){
+    run_stats.on = 1;
+    run_stats.phase = PHASE_PARSE;
+    clock_gettime(CLOCK_MONOTONIC, &run_stats.since);
+}
+
+/**
+ * Function to add the time since the last switch to the current phase and
+ * start timing another
+ *
+ * Return: the phase timed until now
+*/
+int stats_phase(int phase){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int prev = run_stats.phase;
+    run_stats.seconds[prev] += (now.tv_sec - run_stats.since.tv_sec) + (now.tv_nsec - run_stats.since.tv_nsec) / 1e9;
+    run_stats.since = now;
+    run_stats.phase = phase;
+    return prev;
+}
+
+/**
+ * Function to print the counters and the time of each phase as a JSON object,
+ * closing the phase being timed
+*/
+void print_stats(){
+    stats_phase(PHASE_OUTPUT);
+    printf("{\"counters\": {\"blocks_scanned\": %lld, \"frames_scanned\": %lld, \"lru_scans\": %lld, "
+        "\"queue_ops\": %lld, \"evictions\": %lld, \"refaults\": %lld}, \"seconds\": {",
+        run_stats.blocks_scanned, run_stats.frames_scanned, run_stats.lru_scans,
+        run_stats.queue_ops, run_stats.evictions, run_stats.refaults);
+    for (int i = 0; i < PHASE_NUMBER; i++) printf("%s\"%s\": %.6f", i ? ", " : "", phase_names[i], run_stats.seconds[i]);
+    printf("}}\n");
+}
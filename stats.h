@@ -0,0 +1,53 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// phases the wall-clock time of a run is split into, see stats_phase
+#define PHASE_PARSE 0 // reading the trace
+#define PHASE_ARRIVAL 1 // taking processes that arrive, and reading them from a stream
+#define PHASE_ALLOCATION 2 // admitting, placing and freeing processes in memory
+#define PHASE_EVICTION 3 // evicting pages to make room
+#define PHASE_OUTPUT 4 // logging events and printing the results
+#define PHASE_SCHEDULE 5 // everything else: picking processes and advancing time
+#define PHASE_NUMBER 6
+
+typedef struct Run_stats{
+    int on; // 1 once --stats asks for the counters, phases are only timed then
+    long long blocks_scanned; // hole index nodes visited to find a hole
+    long long frames_scanned; // frames looked at to load or evict pages
+    long long lru_scans; // processes and frames looked at to find an eviction victim
+    long long queue_ops; // processes added to, taken from or set aside in the ready processes
+    long long evictions; // pages evicted to make room for another process
+    long long refaults; // evicted pages loaded into frames again
+    int phase; // phase being timed
+    struct timespec since; // when the current phase started
+    double seconds[PHASE_NUMBER]; // time spent in each phase
+} Run_stats;
+
+// counters of the run on this thread; sweep runs never turn them on
+extern __thread Run_stats run_stats;
+
+void stats_start();
+
+int stats_phase(int phase);
+
+void print_stats();
+
+/**
+ * The counters cost an add each and phases two clock reads per switch with
+ * --stats. Building with -DNO_STATS (make nostats) removes them altogether.
+*/
+#ifndef NO_STATS
+#define STAT_ADD(counter, n) (run_stats.counter += (n))
+// switch to a phase, giving back the phase to return to
+#define STAT_PHASE(phase) (run_stats.on ? stats_phase(phase) : (phase))
+#else
+static inline int stat_no_phase(int phase){ return phase; }
+#define STAT_ADD(counter, n) ((void)0)
+#define STAT_PHASE(phase) stat_no_phase(phase)
+#endif
+
+#endif
@@ -0,0 +1,226 @@
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include "stream.h"
+
+/**
+ * Function to parse a non-negative integer at pos, moving pos past it
+ *
+ * Return: 0 for success or -1 if there are no digits or the value overflows
+*/
+static int parse_number(const char **pos, const char *end, long long *value){
+    const char *c = *pos;
+    long long v = 0;
+    if (c == end || *c < '0' || *c > '9') return -1;
+    while (c < end && *c >= '0' && *c <= '9') {
+        int d = *c - '0';
+        if (v >= LLONG_MAX / 10 && (v > LLONG_MAX / 10 || d > LLONG_MAX % 10)) return -1;
+        v = v * 10 + d;
+        c++;
+    }
+    *pos = c;
+    *value = v;
+    return 0;
+}
+
+/**
+ * Function to skip spaces, tabs and carriage returns within a line
+*/
+const char* skip_blank(const char *c, const char *end){
+    while (c < end && (*c == ' ' || *c == '\t' || *c == '\r')) c++;
+    return c;
+}
+
+/**
+ * Function to parse the fields of one process line at pos, stopping at its
+ * newline or at the end of the trace
+ *
+ * Return: 0 for success or -1 if the line is malformed
+*/
+int parse_line(const char **pos, const char *end, long long *t_arr, char *pname, long long *t_serv, long long *mem){
+    const char *c = *pos;
+    if (parse_number(&c, end, t_arr) == -1) return -1;
+
+    // the name runs to the next blank
+    c = skip_blank(c, end);
+    const char *name = c;
+    while (c < end && *c != ' ' && *c != '\t' && *c != '\r' && *c != '\n') c++;
+    if (c == name || c - name > MAX_NAME_LENGTH) return -1;
+    memcpy(pname, name, c - name);
+    pname[c - name] = '\0';
+
+    c = skip_blank(c, end);
+    if (parse_number(&c, end, t_serv) == -1) return -1;
+    c = skip_blank(c, end);
+    if (parse_number(&c, end, mem) == -1 || *mem > INT_MAX) return -1;
+    c = skip_blank(c, end);
+    if (c < end && *c != '\n') return -1;
+    *pos = c;
+    return 0;
+}
+
+/**
+ * Function to take a record from the record pool of a stream, which grows by
+ * a chunk when it is empty. A reused record keeps its frame list buffer.
+*/
+static Process* new_record(Process_stream *stream){
+    if (stream->spare_cnt == 0) {
+        Record_chunk *chunk = (Record_chunk*)malloc(sizeof(Record_chunk));
+        chunk->next = stream->chunks;
+        stream->chunks = chunk;
+        int cap = stream->table.cnt + RECORD_CHUNK;
+        stream->table.at = (Process**)realloc(stream->table.at, sizeof(Process*) * cap);
+        stream->spare = (int*)realloc(stream->spare, sizeof(int) * cap);
+        for (int i = 0; i < RECORD_CHUNK; i++) {
+            chunk->records[i].frames = NULL;
+            chunk->records[i].frames_cap = 0;
+            chunk->records[i].slot = stream->table.cnt;
+            stream->spare[stream->spare_cnt++] = stream->table.cnt;
+            stream->table.at[stream->table.cnt++] = &chunk->records[i];
+        }
+    }
+    Process *p = stream->table.at[stream->spare[--stream->spare_cnt]];
+    stream->live++;
+    if (stream->live > stream->peak) stream->peak = stream->live;
+    return p;
+}
+
+/**
+ * Function to read more of a stream into its buffer, keeping the line being
+ * parsed. Events logged so far are written out first, since a live feed may
+ * not send the next line for a while.
+*/
+static void fill_stream(Process_stream *stream){
+    memmove(stream->buf, stream->buf + stream->pos, stream->len - stream->pos);
+    stream->len -= stream->pos;
+    stream->pos = 0;
+    if (stream->len == stream->cap) {
+        stream->cap *= 2;
+        stream->buf = (char*)realloc(stream->buf, stream->cap);
+    }
+    out_flush();
+    fflush(stdout);
+    ssize_t got = read(stream->fd, stream->buf + stream->len, stream->cap - stream->len);
+    if (got == -1 && errno != EINTR) {
+        fprintf(stderr, "Cannot read %s\n", stream->name);
+        exit(EXIT_FAILURE);
+    }
+    if (got == 0) stream->eof = 1;
+    if (got > 0) stream->len += got;
+}
+
+/**
+ * Function to read the next process of a stream into stream->next, or set it
+ * to NULL at the end of the stream. Processes must come in the order of the
+ * quantum they arrive in, as a stream cannot be sorted.
+*/
+static void read_ahead(Process_stream *stream){
+    stream->next = NULL;
+    while (1) {
+        char *start = stream->buf + stream->pos;
+        char *newline = memchr(start, '\n', stream->len - stream->pos);
+        if (newline == NULL && !stream->eof) {
+            fill_stream(stream);
+            continue;
+        }
+        if (newline == NULL && stream->pos == stream->len) return;
+
+        // the last line may have no newline
+        const char *end = newline ? newline : stream->buf + stream->len;
+        stream->pos = newline ? newline + 1 - stream->buf : stream->len;
+        stream->line++;
+        const char *c = skip_blank(start, end);
+        if (c == end) continue; // skip blank lines
+
+        long long t_arr, t_serv, mem;
+        char pname[MAX_NAME_LENGTH + 1];
+        if (parse_line(&c, end, &t_arr, pname, &t_serv, &mem) == -1) {
+            fprintf(stderr, "Invalid process on line %d of %s\n", stream->line, stream->name);
+            exit(EXIT_FAILURE);
+        }
+        Process *p = new_record(stream);
+        int *frames = p->frames, frames_cap = p->frames_cap;
+        initialize_p(p, pname, t_arr, t_serv, (int)mem);
+        p->frames = frames;
+        p->frames_cap = frames_cap;
+        p->id = stream->read++;
+
+        long long window = arrival_window(p, stream->quantum);
+        if (window < stream->window) {
+            fprintf(stderr, "Process on line %d of %s arrives in an earlier quantum than the one before it\n", stream->line, stream->name);
+            exit(EXIT_FAILURE);
+        }
+        stream->window = window;
+        stream->next = p;
+        return;
+    }
+}
+
+/**
+ * Function to open a stream of processes on a file descriptor and read
+ * ahead its first process
+ *
+ * Return: the stream
+*/
+Process_stream* open_stream(int fd, char *name, int quantum){
+    Process_stream *stream = (Process_stream*)calloc(1, sizeof(Process_stream));
+    stream->fd = fd;
+    stream->name = name;
+    stream->cap = STREAM_CHUNK;
+    stream->buf = (char*)malloc(stream->cap);
+    stream->quantum = quantum;
+    read_ahead(stream);
+    return stream;
+}
+
+/**
+ * Function to take the next process of a stream that has arrived by a time
+ * stamp, reading ahead the one after it. The run cannot go past a time stamp
+ * before it knows whether another process arrives by then, so on a live feed
+ * the events of a time stamp are written once the next line comes in.
+ *
+ * Return: the process, or NULL if the next one has not arrived yet
+*/
+Process* stream_take(Process_stream *stream, long long time_stamp){
+    Process *p = stream->next;
+    if (p == NULL || p->arr_time > time_stamp) return NULL;
+    read_ahead(stream);
+    return p;
+}
+
+/**
+ * Function to find the arrival time of the next process of a stream
+ *
+ * Return: the next arrival time, or -1 at the end of the stream
+*/
+long long stream_next_arrival(Process_stream *stream){
+    return stream->next ? stream->next->arr_time : -1;
+}
+
+/**
+ * Function to release a finished process, adding it to the performance
+ * totals of the stream. Its record is reused for a later process.
+ * Overheads are summed in the order processes finish rather than trace
+ * order, so the average may round the other way at an exact tie.
+*/
+void stream_release(Process_stream *stream, Process *p){
+    add_performance(&stream->totals, p);
+    stream->spare[stream->spare_cnt++] = p->slot;
+    stream->live--;
+}
+
+/**
+ * Function to free a stream and every record of its record pool
+*/
+void free_stream(Process_stream *stream){
+    while (stream->chunks != NULL) {
+        Record_chunk *chunk = stream->chunks;
+        stream->chunks = chunk->next;
+        for (int i = 0; i < RECORD_CHUNK; i++) free(chunk->records[i].frames);
+        free(chunk);
+    }
+    free(stream->table.at);
+    free(stream->spare);
+    free(stream->buf);
+    free(stream);
+}
@@ -0,0 +1,60 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "process_q.h"
+#include "output.h"
+
+#define STREAM_CHUNK (1 << 16) // initial size of the buffer a stream is read into
+#define RECORD_CHUNK 256 // number of process records the record pool of a stream grows by
+
+typedef struct Record_chunk {
+    struct Record_chunk *next; // the chunk allocated before this one
+    Process records[RECORD_CHUNK];
+} Record_chunk;
+
+/**
+ * Processes read from a file descriptor as the simulation reaches their
+ * arrival, for traces that are too long to load or still being written.
+ * Records of finished processes are folded into performance totals and
+ * reused, so memory follows the processes that have arrived and not finished.
+*/
+struct Process_stream {
+    int fd; // where the processes are read from
+    char *name; // name of the stream in messages
+    char *buf; // bytes read and not parsed yet are buf[pos..len)
+    int pos;
+    int len;
+    int cap; // capacity of buf
+    int eof; // 1 once read reaches the end of the stream
+    int line; // lines parsed so far
+    int quantum; // quantum the arrival windows are measured in
+    Process *next; // the next process to arrive, read ahead, NULL at the end of the stream
+    long long window; // arrival window of the last process read
+    int read; // processes read so far, the id of the next one
+    int live; // records holding processes that have not finished
+    int peak; // most records ever live at once
+    int *spare; // slots of the unused records in the record pool
+    int spare_cnt; // number of unused records
+    Record_chunk *chunks; // every chunk the record pool has allocated
+    Process_table table; // every record by slot, for the frames and the ready processes
+    Perf_totals totals; // performance of the processes released so far
+};
+
+const char* skip_blank(const char *c, const char *end);
+
+int parse_line(const char **pos, const char *end, long long *t_arr, char *pname, long long *t_serv, long long *mem);
+
+Process_stream* open_stream(int fd, char *name, int quantum);
+
+Process* stream_take(Process_stream *stream, long long time_stamp);
+
+long long stream_next_arrival(Process_stream *stream);
+
+void stream_release(Process_stream *stream, Process *p);
+
+void free_stream(Process_stream *stream);
+
+#endif
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "process_q.h"
+#include "output.h"
+
+#define RECORD_BATCH 4096 // records read from the trace at a time
+
+/**
+ * Function to log frames first to last of a frame list, closing the list
+ * after last if close is set
+*/
+void log_frames(int first, int last, int close){
+    for (int i = first; i < last; i++) log_frame(i);
+    if (close) log_last_frame(last);
+    else log_frame(last);
+}
+
+/**
+ * Function to log the frame ranges of a binary record, closing the frame
+ * list if the record ends it
+*/
+void log_ranges(Event_record *r){
+    int close = r->flags & FRAMES_CLOSED;
+    if (r->type == EV_FRAMES) {
+        for (int k = 0; k < r->style; k++) log_frames(r->ranges[k][0], r->ranges[k][1], close && k == r->style - 1);
+    } else if (r->first != -1) {
+        log_frames(r->first, r->last, close);
+    } else if (close) {
+        log_frames_end();
+    }
+}
+
+/**
+ * Converts a binary event trace written by allocate -b back to the text
+ * event log and performance statistics allocate prints.
+ *
+ * Usage: trace2text <trace>
+*/
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <trace>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    FILE *f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    Trace_header header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(Event_record) || header.p_cnt < 0 || header.cpus < 1) {
+        fprintf(stderr, "%s is not a binary event trace\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    // rebuild the processes, their completion times come from FINISHED records
+    int p_cnt = header.p_cnt;
+    Process *slab = (Process*)malloc(sizeof(Process) * (p_cnt > 0 ? p_cnt : 1));
+    Process **proc_list = (Process**)malloc(sizeof(Process*) * (p_cnt > 0 ? p_cnt : 1));
+    for (int i = 0; i < p_cnt; i++) {
+        Trace_process entry;
+        char pname[MAX_NAME_LENGTH + 1];
+        if (fread(&entry, sizeof(entry), 1, f) != 1) {
+            fprintf(stderr, "%s is truncated\n", argv[1]);
+            exit(EXIT_FAILURE);
+        }
+        memcpy(pname, entry.pname, MAX_NAME_LENGTH);
+        pname[MAX_NAME_LENGTH] = '\0';
+        initialize_p(&slab[i], pname, entry.arr_time, entry.serv_time, 0);
+        slab[i].id = i;
+        slab[i].slot = i;
+        proc_list[i] = &slab[i];
+    }
+
+    out_init(OUT_TEXT, header.cpus);
+    long long makespan = 0;
+    int page_stats = 0, evictions = 0, refaults = 0;
+    int compact_stats = 0, compactions = 0;
+    long long moved = 0;
+    Event_record *records = (Event_record*)malloc(sizeof(Event_record) * RECORD_BATCH);
+    size_t cnt;
+    while ((cnt = fread(records, sizeof(Event_record), RECORD_BATCH, f)) > 0) {
+        for (size_t k = 0; k < cnt; k++) {
+            Event_record *r = &records[k];
+            if (r->pid < -1 || r->pid >= p_cnt || ((r->type == EV_RUNNING || r->type == EV_FINISHED) && r->pid == -1)) {
+                fprintf(stderr, "%s has a record of an unknown process\n", argv[1]);
+                exit(EXIT_FAILURE);
+            }
+            Process *p = r->pid == -1 ? NULL : &slab[r->pid];
+            if (p) p->cpu = r->flags >> CPU_SHIFT;
+            switch (r->type) {
+                case EV_RUNNING:
+                p->rem_time = r->value;
+                if (r->style == RUN_PLAIN) log_running(r->time, p);
+                else if (r->style == RUN_AT) log_running_at(r->time, p, r->usage, r->first);
+                else {
+                    log_running_frames(r->time, p, r->usage);
+                    log_ranges(r);
+                }
+                break;
+
+                case EV_FINISHED:
+                log_finished(r->time, p, r->value);
+                p->complete_time = r->time;
+                makespan = r->time;
+                break;
+
+                case EV_EVICTED:
+                log_evicted(r->time);
+                log_ranges(r);
+                break;
+
+                case EV_FRAMES:
+                log_ranges(r);
+                break;
+
+                case EV_COMPACTED:
+                log_compacted(r->time, r->value, r->usage);
+                break;
+
+                case EV_COMPACT_STATS:
+                compact_stats = 1;
+                compactions = r->first;
+                moved = r->value;
+                break;
+
+                case EV_PAGE_STATS:
+                page_stats = 1;
+                evictions = r->value;
+                refaults = r->first;
+                break;
+            }
+        }
+    }
+    fclose(f);
+
+    out_close();
+    print_performance(proc_list, p_cnt, makespan);
+    if (page_stats) {
+        printf("Evictions %d\n", evictions);
+        printf("Refaults %d\n", refaults);
+    }
+    if (compact_stats) {
+        printf("Compactions %d\n", compactions);
+        printf("Moved %lld\n", moved);
+    }
+
+    free(records);
+    free(proc_list);
+    free(slab);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define MAX_PROCESSES 10000000 // process names P0 to P9999999 fit in 8 characters
+
+// arrival distributions
+#define ARRIVE_POISSON 0 // exponential gaps between single arrivals
+#define ARRIVE_BURSTY 1 // bursts of processes arriving together, exponential gaps between bursts
+
+// service time and memory size distributions
+#define DIST_UNIFORM 0 // uniform from 1 up to the maximum
+#define DIST_EXPONENTIAL 1 // exponential around the mean, at least 1 and at most the maximum
+#define DIST_POWER 2 // powers of two up to the maximum, memory only
+
+typedef struct Workload{
+    long count; // number of processes
+    int arrival; // ARRIVE_POISSON or ARRIVE_BURSTY
+    double gap; // mean time between arrivals, above the mean service time so queues stay short
+    int burst; // processes per burst for ARRIVE_BURSTY
+    int service; // service time distribution
+    long max_service; // longest service time, the mean is half of it
+    int memory; // memory size distribution
+    int max_memory; // largest memory size in KB
+    unsigned long long seed; // seed of the generator, the same seed gives the same trace
+} Workload;
+
+/**
+ * Function to draw the next 64 random bits (xorshift64*), so a seed gives the
+ * same trace on every platform
+*/
+static unsigned long long next_random(unsigned long long *state){
+    unsigned long long x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 2685821657736338717ull;
+}
+
+/**
+ * Function to draw a number uniformly from [0, 1)
+*/
+static double uniform(unsigned long long *state){
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Function to draw an exponentially distributed number with the given mean
+*/
+static double exponential(unsigned long long *state, double mean){
+    return -mean * log(1.0 - uniform(state));
+}
+
+/**
+ * Function to draw a value between 1 and max from a distribution
+*/
+static long draw(unsigned long long *state, int dist, long max){
+    long v;
+    if (dist == DIST_EXPONENTIAL) {
+        v = 1 + (long)exponential(state, max / 2.0);
+    } else if (dist == DIST_POWER) {
+        int bits = 0;
+        while ((2L << bits) <= max) bits++;
+        v = 1L << (next_random(state) % (bits + 1));
+    } else {
+        v = 1 + (long)(uniform(state) * max);
+    }
+    return v > max ? max : v;
+}
+
+/**
+ * Function to read a positive number given for a command line option
+ *
+ * Return: the number, exits if it is not a positive integer no greater than max
+*/
+static long read_count(char *option, char *value, long max){
+    char *end;
+    long n = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || n < 1 || n > max) {
+        fprintf(stderr, "Invalid value for %s: %s\n", option, value);
+        exit(EXIT_FAILURE);
+    }
+    return n;
+}
+
+/**
+ * Function to read a distribution name given for a command line option
+*/
+static int read_dist(char *option, char *value, int allow_power){
+    if (strcmp(value, "uniform") == 0) return DIST_UNIFORM;
+    if (strcmp(value, "exponential") == 0) return DIST_EXPONENTIAL;
+    if (allow_power && strcmp(value, "power") == 0) return DIST_POWER;
+    fprintf(stderr, "Invalid value for %s: %s\n", option, value);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Generates a synthetic trace for allocate, one process per line in arrival
+ * order, for benchmarking.
+ *
+ * Usage: workload -n <processes> [-a poisson|bursty] [-g <mean gap>]
+ *        [-B <burst size>] [-t uniform|exponential] [-T <max service>]
+ *        [-m uniform|exponential|power] [-M <max memory>] [-r <seed>]
+*/
+int main(int argc, char *argv[]) {
+    Workload w = {0, ARRIVE_POISSON, 8.0, 8, DIST_UNIFORM, 10, DIST_UNIFORM, 64, 30023};
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 == argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+        char *option = argv[i], *value = argv[++i];
+        if (strcmp(option, "-n") == 0) {
+            w.count = read_count(option, value, MAX_PROCESSES);
+        } else if (strcmp(option, "-a") == 0) {
+            if (strcmp(value, "poisson") == 0) w.arrival = ARRIVE_POISSON;
+            else if (strcmp(value, "bursty") == 0) w.arrival = ARRIVE_BURSTY;
+            else {
+                fprintf(stderr, "Invalid value for %s: %s\n", option, value);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(option, "-g") == 0) {
+            char *end;
+            w.gap = strtod(value, &end);
+            if (*value == '\0' || *end != '\0' || !(w.gap >= 0 && w.gap <= 1e9)) {
+                fprintf(stderr, "Invalid value for %s: %s\n", option, value);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(option, "-B") == 0) {
+            w.burst = read_count(option, value, MAX_PROCESSES);
+        } else if (strcmp(option, "-t") == 0) {
+            w.service = read_dist(option, value, 0);
+        } else if (strcmp(option, "-T") == 0) {
+            w.max_service = read_count(option, value, 1000000000L);
+        } else if (strcmp(option, "-m") == 0) {
+            w.memory = read_dist(option, value, 1);
+        } else if (strcmp(option, "-M") == 0) {
+            w.max_memory = read_count(option, value, 1 << 20);
+        } else if (strcmp(option, "-r") == 0) {
+            w.seed = read_count(option, value, 0x7fffffffffffffffL);
+        } else {
+            fprintf(stderr, "Invalid argument: %s\n", option);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (!w.count) {
+        fprintf(stderr, "Missing required arguments.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    static char buf[1 << 16];
+    setvbuf(stdout, buf, _IOFBF, sizeof(buf));
+    unsigned long long state = w.seed * 0x9e3779b97f4a7c15ull + 1; // xorshift must not start at 0
+    double clock = 0;
+    for (long i = 0; i < w.count; i++) {
+        if (i > 0) {
+            if (w.arrival == ARRIVE_POISSON) clock += exponential(&state, w.gap);
+            else if (i % w.burst == 0) clock += exponential(&state, w.gap * w.burst);
+        }
+        long serv = draw(&state, w.service, w.max_service);
+        long mem = draw(&state, w.memory, w.max_memory);
+        printf("%lld P%ld %ld %ld\n", (long long)clock, i, serv, mem);
+    }
+    return EXIT_SUCCESS;
+}